@@ -0,0 +1,95 @@
+// Feeds random frames to the per-block bit counters and checks that the vector kernel, the scalar
+// kernel and the original byte-by-byte counting agree bit for bit.
+//
+//   ./bench/bit_stats_bench [frames]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "core/streams/bit_stats.h"
+
+namespace {
+
+// The per-byte counters MessageState kept before blocks were counted at once
+struct ByteCounts {
+  uint32_t flips[8] = {};
+  uint32_t highs[8] = {};
+};
+
+void referenceAccumulate(ByteCounts* counts, uint64_t cur, uint64_t diff) {
+  for (int byte = 0; byte < 8; ++byte) {
+    const uint8_t byte_diff = diff >> (byte * 8);
+    if (byte_diff == 0) continue;
+    const uint8_t v = cur >> (byte * 8);
+    for (int bit = 0; bit < 8; ++bit) {
+      counts[byte].highs[bit] += (v >> (7 - bit)) & 1;
+      counts[byte].flips[bit] += (byte_diff >> (7 - bit)) & 1;
+    }
+  }
+}
+
+bool matches(const BitStats& s, const ByteCounts* counts) {
+  for (int byte = 0; byte < 8; ++byte) {
+    for (int bit = 0; bit < 8; ++bit) {
+      if (s.highCount(byte, bit) != counts[byte].highs[bit] || s.flipCount(byte, bit) != counts[byte].flips[bit]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename Fn>
+double timeNs(size_t frames, Fn&& fn) {
+  const auto t0 = std::chrono::steady_clock::now();
+  fn();
+  const auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / frames;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const size_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+
+  // Most bytes of a real frame keep their value, so each byte changes with a random per-run odds,
+  // and some bits are ignored as a mask would
+  std::mt19937_64 rng(42);
+  std::vector<uint64_t> cur(frames), diff(frames);
+  uint64_t last = rng();
+  for (size_t i = 0; i < frames; ++i) {
+    uint64_t next = last;
+    const int odds = 1 + i / 4096 % 8;
+    for (int byte = 0; byte < 8; ++byte) {
+      if (rng() % 8 < (uint64_t)odds) next ^= (rng() & 0xFF) << (byte * 8);
+    }
+    const uint64_t ignore = (i / 65536 % 2) ? 0x00F0'0000'FF00'000FULL : 0;
+    cur[i] = next;
+    diff[i] = (next ^ last) & ~ignore;
+    last = next;
+  }
+
+  ByteCounts reference[8] = {};
+  BitStats scalar, vector;
+  const double ref_ns = timeNs(frames, [&] {
+    for (size_t i = 0; i < frames; ++i) referenceAccumulate(reference, cur[i], diff[i]);
+  });
+  const double scalar_ns = timeNs(frames, [&] {
+    for (size_t i = 0; i < frames; ++i) bit_stats::accumulateScalar(scalar, cur[i], diff[i]);
+  });
+  const double vector_ns = timeNs(frames, [&] {
+    for (size_t i = 0; i < frames; ++i) bit_stats::accumulate(vector, cur[i], diff[i]);
+  });
+
+  const bool scalar_ok = matches(scalar, reference);
+  const bool vector_ok = std::memcmp(&scalar, &vector, sizeof(BitStats)) == 0 && matches(vector, reference);
+  std::printf("%-10s %10s\n", "kernel", "ns/block");
+  std::printf("%-10s %10.2f\n", "per byte", ref_ns);
+  std::printf("%-10s %10.2f%s\n", "scalar", scalar_ns, scalar_ok ? "" : "  MISMATCH");
+  std::printf("%-10s %10.2f%s\n", "vector", vector_ns, vector_ok ? "" : "  MISMATCH");
+  return scalar_ok && vector_ok ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+// Loads every DBC in a directory with dbc::File and with the regular expression parser it
+// replaced, and checks that both build the same messages and signals.
+//
+//   ./bench/dbc_parse_bench [dir] [iterations]
+
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+
+#include "core/dbc/dbc_file.h"
+
+namespace {
+
+// The parser dbc::File used before the tokenizer. Line numbers count the continuation lines of
+// multi-line comments, as dbc::File now does.
+std::map<uint32_t, dbc::Msg> referenceParse(const QString& path) {
+  static const QRegularExpression RE_SIGNAL(
+      R"(^SG_\s+(?<name>\w+)\s*(?<mux>M|m\d+)?\s*:\s*(?<start>\d+)\|(?<size>\d+)@(?<endian>[01])(?<sign>[\+-])\s*\((?<factor>[0-9.+\-eE]+),(?<offset>[0-9.+\-eE]+)\)\s*\[(?<min>[0-9.+\-eE]+)\|(?<max>[0-9.+\-eE]+)\]\s*\"(?<unit>.*)\"\s*(?<receiver>.*))");
+  static const QRegularExpression RE_MESSAGE(
+      R"(^BO_ (?<address>\w+) (?<name>\w+) *: (?<size>\w+) (?<transmitter>\w+))");
+  static const QRegularExpression RE_COMMENT(R"(CM_\s+(BO_|SG_)\s+(\d+)\s*(\w+)?\s*\"(.*)\"\s*;)",
+                                             QRegularExpression::DotMatchesEverythingOption);
+  static const QRegularExpression RE_VALUE_HEADER(R"(VAL_\s+(\d+)\s+(\w+))");
+  static const QRegularExpression RE_VALUE_PAIR(R"((-?\d+)\s+\"([^\"]*)\")");
+
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) throw std::runtime_error("Failed to open file.");
+  const QString content = file.readAll();
+
+  std::map<uint32_t, dbc::Msg> msgs;
+  auto find_signal = [&](uint32_t address, const QString& name) -> dbc::Signal* {
+    auto it = msgs.find(address);
+    return it != msgs.end() ? it->second.sig(name) : nullptr;
+  };
+
+  int line_num = 0;
+  dbc::Msg* current_msg = nullptr;
+  int multiplexor_cnt = 0;
+  QTextStream stream((QString*)&content);
+  while (!stream.atEnd()) {
+    ++line_num;
+    QString line = stream.readLine().trimmed();
+    try {
+      if (line.startsWith("BO_ ")) {
+        multiplexor_cnt = 0;
+        auto match = RE_MESSAGE.match(line);
+        if (!match.hasMatch()) throw std::runtime_error("Invalid BO_ line format");
+        uint32_t address = match.captured("address").toUInt();
+        if (msgs.count(address) > 0)
+          throw std::runtime_error(QString("Duplicate message address: %1").arg(address).toStdString());
+        current_msg = &msgs[address];
+        current_msg->address = address;
+        current_msg->name = match.captured("name");
+        current_msg->size = match.captured("size").toULong();
+        current_msg->transmitter = match.captured("transmitter").trimmed();
+      } else if (line.startsWith("SG_ ")) {
+        if (!current_msg) throw std::runtime_error("Signal defined before any Message (BO_)");
+        auto match = RE_SIGNAL.match(line);
+        if (!match.hasMatch()) throw std::runtime_error("Invalid SG_ line format");
+        QString name = match.captured("name");
+        if (current_msg->sig(name) != nullptr)
+          throw std::runtime_error(QString("Duplicate signal name: %1").arg(name).toStdString());
+
+        dbc::Signal s{};
+        s.name = name;
+        QString mux = match.captured("mux");
+        if (mux == "M") {
+          if (++multiplexor_cnt >= 2)
+            throw std::runtime_error("Multiple multiplexor switch signals (M) found in one message");
+          s.type = dbc::Signal::Type::Multiplexor;
+        } else if (mux.startsWith('m')) {
+          s.type = dbc::Signal::Type::Multiplexed;
+          s.multiplex_value = mux.mid(1).toInt();
+        } else {
+          s.type = dbc::Signal::Type::Normal;
+        }
+        s.start_bit = match.captured("start").toInt();
+        s.size = match.captured("size").toInt();
+        s.is_little_endian = (match.captured("endian") == "1");
+        s.is_signed = (match.captured("sign") == "-");
+        s.factor = match.captured("factor").toDouble();
+        s.offset = match.captured("offset").toDouble();
+        s.min = match.captured("min").toDouble();
+        s.max = match.captured("max").toDouble();
+        s.unit = match.captured("unit");
+        s.receiver_name = match.captured("receiver").trimmed();
+        current_msg->sigs.push_back(new dbc::Signal(s));
+      } else if (line.startsWith("VAL_ ")) {
+        auto header_match = RE_VALUE_HEADER.match(line);
+        if (!header_match.hasMatch()) continue;
+        if (auto s = find_signal(header_match.captured(1).toUInt(), header_match.captured(2))) {
+          s->value_table.clear();
+          auto it = RE_VALUE_PAIR.globalMatch(line);
+          while (it.hasNext()) {
+            auto match = it.next();
+            s->value_table.push_back({match.captured(1).toDouble(), match.captured(2)});
+          }
+        }
+      } else if (line.startsWith("CM_ BO_") || line.startsWith("CM_ SG_ ")) {
+        while (!line.endsWith(';') && !stream.atEnd()) {
+          ++line_num;
+          line += "\n" + stream.readLine();
+        }
+        auto match = RE_COMMENT.match(line);
+        if (!match.hasMatch()) continue;
+        uint32_t address = match.captured(2).toUInt();
+        QString comment = match.captured(4).replace("\\\"", "\"").trimmed();
+        if (match.captured(1) == "BO_") {
+          if (auto it = msgs.find(address); it != msgs.end()) it->second.comment = comment;
+        } else if (auto s = find_signal(address, match.captured(3))) {
+          s->comment = comment;
+        }
+      }
+    } catch (std::exception& e) {
+      throw std::runtime_error(
+          QString("[%1:%2]%3: %4").arg(path).arg(line_num).arg(e.what()).arg(line).toStdString());
+    }
+  }
+
+  for (auto& [_, m] : msgs) {
+    m.update();
+  }
+  return msgs;
+}
+
+bool sameMessages(const std::map<uint32_t, dbc::Msg>& a, const std::map<uint32_t, dbc::Msg>& b) {
+  if (a.size() != b.size()) return false;
+  for (auto ia = a.begin(), ib = b.begin(); ia != a.end(); ++ia, ++ib) {
+    const dbc::Msg &ma = ia->second, &mb = ib->second;
+    if (ia->first != ib->first || ma.name != mb.name || ma.size != mb.size || ma.transmitter != mb.transmitter ||
+        ma.comment != mb.comment || ma.sigs.size() != mb.sigs.size()) {
+      return false;
+    }
+    for (size_t k = 0; k < ma.sigs.size(); ++k) {
+      if (*ma.sigs[k] != *mb.sigs[k]) return false;
+    }
+  }
+  return true;
+}
+
+template <typename Fn>
+double timeMs(int iterations, Fn&& fn) {
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) fn();
+  const auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const QString dir = argc > 1 ? argv[1] : "data/opendbc";
+  const int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+
+  const QStringList files = QDir(dir).entryList({"*.dbc"}, QDir::Files, QDir::Name);
+  if (files.isEmpty()) {
+    std::fprintf(stderr, "no DBC files in %s\n", qPrintable(dir));
+    return 1;
+  }
+
+  bool all_ok = true;
+  size_t total_signals = 0;
+  double total_ref = 0, total_new = 0;
+  std::printf("%-48s %8s %10s %10s %8s\n", "file", "signals", "regex ms", "parse ms", "speedup");
+  for (const QString& name : files) {
+    const QString path = QDir(dir).filePath(name);
+    std::map<uint32_t, dbc::Msg> expected;
+    std::string expected_error, error;
+    try {
+      expected = referenceParse(path);
+    } catch (std::exception& e) {
+      expected_error = e.what();
+    }
+
+    bool ok = true;
+    try {
+      dbc::File file(path);
+      ok = expected_error.empty() && sameMessages(expected, file.getMessages());
+    } catch (std::exception& e) {
+      error = e.what();
+      ok = error == expected_error;
+    }
+
+    size_t signal_count = 0;
+    for (const auto& [_, m] : expected) signal_count += m.sigs.size();
+
+    double ref_ms = 0, new_ms = 0;
+    if (expected_error.empty()) {
+      ref_ms = timeMs(iterations, [&] { referenceParse(path); });
+      new_ms = timeMs(iterations, [&] { dbc::File file(path); });
+    }
+
+    all_ok = all_ok && ok;
+    total_signals += signal_count;
+    total_ref += ref_ms;
+    total_new += new_ms;
+    std::printf("%-48s %8zu %10.3f %10.3f %7.1fx%s\n", qPrintable(name), signal_count, ref_ms, new_ms,
+                new_ms > 0 ? ref_ms / new_ms : 0.0, ok ? "" : "  MISMATCH");
+    if (!error.empty() || !expected_error.empty()) {
+      std::printf("  regex: %s\n  parse: %s\n", expected_error.c_str(), error.c_str());
+    }
+  }
+  std::printf("%-48s %8zu %10.3f %10.3f %7.1fx\n", "total", total_signals, total_ref, total_new,
+              total_ref / total_new);
+  return all_ok ? 0 : 1;
+}
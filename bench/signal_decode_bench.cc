@@ -0,0 +1,172 @@
+// Compares the compiled signal extractor and the batch APIs against the original
+// byte-by-byte decoder, and checks that they all agree bit for bit.
+//
+//   ./bench/signal_decode_bench [frames]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/dbc/dbc_message.h"
+
+namespace {
+
+// The decoder dbc::Signal used before extractors were compiled
+uint64_t referenceRaw(const dbc::Signal& s, const uint8_t* data, size_t data_size) {
+  const int msb_byte = s.msb / 8;
+  if (msb_byte >= (int)data_size) return 0;
+
+  const int lsb_byte = s.lsb / 8;
+  uint64_t val = 0;
+  if (msb_byte == lsb_byte) {
+    val = (data[msb_byte] >> (s.lsb & 7)) & ((1ULL << s.size) - 1);
+  } else {
+    int bits = s.size;
+    int i = msb_byte;
+    const int step = s.is_little_endian ? -1 : 1;
+    while (i >= 0 && i < (int)data_size && bits > 0) {
+      const int cur_msb = (i == msb_byte) ? (s.msb & 7) : 7;
+      const int cur_lsb = (i == lsb_byte) ? (s.lsb & 7) : 0;
+      const int nbits = cur_msb - cur_lsb + 1;
+      val = (val << nbits) | ((data[i] >> cur_lsb) & ((1ULL << nbits) - 1));
+      bits -= nbits;
+      i += step;
+    }
+  }
+  return val;
+}
+
+bool referenceParse(const dbc::Signal& s, const uint8_t* data, size_t data_size, double* val) {
+  if (s.multiplexor && referenceRaw(*s.multiplexor, data, data_size) != (uint64_t)s.multiplex_value) {
+    return false;
+  }
+  uint64_t raw = referenceRaw(s, data, data_size);
+  if (s.is_signed && (raw & (1ULL << (s.size - 1)))) {
+    raw |= ~((1ULL << s.size) - 1);
+    *val = static_cast<int64_t>(raw) * s.factor + s.offset;
+  } else {
+    *val = raw * s.factor + s.offset;
+  }
+  return true;
+}
+
+dbc::Signal makeSignal(const char* name, int start_bit, int size, bool little_endian, bool is_signed) {
+  dbc::Signal s;
+  s.name = name;
+  s.start_bit = start_bit;
+  s.size = size;
+  s.is_little_endian = little_endian;
+  s.is_signed = is_signed;
+  s.factor = 0.01;
+  s.offset = -40;
+  updateMsbLsb(s);
+  return s;
+}
+
+template <typename Fn>
+double timeNs(size_t frames, Fn&& fn) {
+  const auto t0 = std::chrono::steady_clock::now();
+  fn();
+  const auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / frames;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const size_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+  constexpr size_t kStride = 8;
+
+  std::mt19937_64 rng(42);
+  std::vector<uint8_t> payloads(frames * kStride);
+  for (auto& b : payloads) b = rng();
+
+  dbc::Signal mux = makeSignal("MUX", 0, 2, true, false);
+  std::vector<dbc::Signal> sigs = {
+      makeSignal("LE_1", 13, 1, true, false),
+      makeSignal("LE_16", 8, 16, true, false),
+      makeSignal("LE_S12", 20, 12, true, true),
+      makeSignal("BE_16", 39, 16, false, false),
+      makeSignal("BE_S13", 7, 13, false, true),
+      makeSignal("LE_48", 16, 48, true, false),
+      makeSignal("MUXED_BE_10", 55, 10, false, false),
+  };
+  sigs.back().multiplexor = &mux;
+  sigs.back().multiplex_value = 1;
+
+  std::vector<double> expected(frames), out(frames);
+  bool all_ok = true;
+  double total_ref = 0, total_single = 0, total_batch = 0;
+  std::printf("%-12s %12s %12s %12s %9s\n", "signal", "ref ns/fr", "parse ns/fr", "batch ns/fr", "speedup");
+  for (const auto& s : sigs) {
+    const double ref_ns = timeNs(frames, [&] {
+      for (size_t i = 0; i < frames; ++i) {
+        if (!referenceParse(s, &payloads[i * kStride], kStride, &expected[i])) expected[i] = NAN;
+      }
+    });
+    const double single_ns = timeNs(frames, [&] {
+      for (size_t i = 0; i < frames; ++i) {
+        if (!s.parse(&payloads[i * kStride], kStride, &out[i])) out[i] = NAN;
+      }
+    });
+    bool ok = std::memcmp(expected.data(), out.data(), frames * sizeof(double)) == 0;
+
+    const double batch_ns = timeNs(frames, [&] { s.parseBatch(payloads.data(), kStride, nullptr, frames, out.data()); });
+    ok = ok && std::memcmp(expected.data(), out.data(), frames * sizeof(double)) == 0;
+
+    all_ok = all_ok && ok;
+    total_ref += ref_ns;
+    total_single += single_ns;
+    total_batch += batch_ns;
+    std::printf("%-12s %12.2f %12.2f %12.2f %8.1fx%s\n", s.name.toStdString().c_str(), ref_ns, single_ns, batch_ns,
+                ref_ns / batch_ns, ok ? "" : "  MISMATCH");
+  }
+  std::printf("%-12s %12.2f %12.2f %12.2f %8.1fx\n", "total", total_ref, total_single, total_batch,
+              total_ref / total_batch);
+
+  // A wide multiplexed message: 8 plain signals plus 4 pages of 12 one-byte or nibble signals
+  dbc::Msg msg;
+  msg.address = 0x100;
+  msg.size = kStride;
+  dbc::Signal page = makeSignal("PAGE", 0, 2, true, false);
+  page.type = dbc::Signal::Type::Multiplexor;
+  msg.addSignal(page);
+  for (int i = 0; i < 8; ++i) {
+    msg.addSignal(makeSignal(("PLAIN_" + std::to_string(i)).c_str(), 2 + i * 7, 7, i % 2, i % 3 == 0));
+  }
+  for (int p = 0; p < 4; ++p) {
+    for (int i = 0; i < 12; ++i) {
+      auto s = makeSignal(("PAGE" + std::to_string(p) + "_" + std::to_string(i)).c_str(), 8 + i * 4, i % 2 ? 8 : 4,
+                          true, false);
+      s.type = dbc::Signal::Type::Multiplexed;
+      s.multiplex_value = p;
+      msg.addSignal(s);
+    }
+  }
+
+  const std::vector<const dbc::Signal*> msg_sigs(msg.sigs.begin(), msg.sigs.end());
+  std::vector<std::vector<double>> per_signal(msg_sigs.size(), std::vector<double>(frames));
+  std::vector<std::vector<double>> per_msg(msg_sigs.size(), std::vector<double>(frames));
+  std::vector<double*> out_ptrs(msg_sigs.size());
+  for (size_t k = 0; k < msg_sigs.size(); ++k) out_ptrs[k] = per_msg[k].data();
+
+  const double signal_ns = timeNs(frames, [&] {
+    for (size_t k = 0; k < msg_sigs.size(); ++k) {
+      msg_sigs[k]->parseBatch(payloads.data(), kStride, nullptr, frames, per_signal[k].data());
+    }
+  });
+  const double msg_ns = timeNs(frames, [&] { msg.parseBatch(msg_sigs, payloads.data(), kStride, nullptr, frames, out_ptrs.data()); });
+  bool msg_ok = true;
+  for (size_t k = 0; k < msg_sigs.size(); ++k) {
+    msg_ok = msg_ok && std::memcmp(per_signal[k].data(), per_msg[k].data(), frames * sizeof(double)) == 0;
+  }
+  all_ok = all_ok && msg_ok;
+  std::printf("\n%zu-signal message: per signal %.2f ns/frame, per message %.2f ns/frame, %.1fx%s\n", msg_sigs.size(),
+              signal_ns, msg_ns, signal_ns / msg_ns, msg_ok ? "" : "  MISMATCH");
+  return all_ok ? 0 : 1;
+}
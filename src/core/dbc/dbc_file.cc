@@ -2,34 +2,147 @@
 
 #include <QFile>
 #include <QFileInfo>
-#include <QRegularExpression>
+#include <QTextStream>
+#include <algorithm>
+#include <optional>
 
 #include "utils/util.h"
 
 namespace dbc {
 
-static QRegularExpression RE_SIGNAL(
-    R"(^SG_\s+(?<name>\w+)\s*(?<mux>M|m\d+)?\s*:\s*(?<start>\d+)\|(?<size>\d+)@(?<endian>[01])(?<sign>[\+-])\s*\((?<factor>[0-9.+\-eE]+),(?<offset>[0-9.+\-eE]+)\)\s*\[(?<min>[0-9.+\-eE]+)\|(?<max>[0-9.+\-eE]+)\]\s*\"(?<unit>.*)\"\s*(?<receiver>.*))");
-static QRegularExpression sgm_regexp(
-    R"(^SG_ (\w+) (\w+) *: (\d+)\|(\d+)@(\d+)([\+|\-]) \(([0-9.+\-eE]+),([0-9.+\-eE]+)\) \[([0-9.+\-eE]+)\|([0-9.+\-eE]+)\] \"(.*)\" (.*))");
-static QRegularExpression RE_MESSAGE(R"(^BO_ (?<address>\w+) (?<name>\w+) *: (?<size>\w+) (?<transmitter>\w+))");
-static const QRegularExpression RE_COMMENT(R"(CM_\s+(BO_|SG_)\s+(\d+)\s*(\w+)?\s*\"(.*)\"\s*;)",
-                                           QRegularExpression::DotMatchesEverythingOption);
-static const QRegularExpression RE_VALUE_HEADER(R"(VAL_\s+(\d+)\s+(\w+))");
-static const QRegularExpression RE_VALUE_PAIR(R"((-?\d+)\s+\"([^\"]*)\")");
+namespace {
+
+inline bool isSpace(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+// ASCII only, like \w in a QRegularExpression without UseUnicodePropertiesOption
+inline bool isWordChar(char c) { return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+inline bool isNumberChar(char c) { return isDigit(c) || c == '.' || c == '+' || c == '-' || c == 'e' || c == 'E'; }
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && isSpace(s.front())) s.remove_prefix(1);
+  while (!s.empty() && isSpace(s.back())) s.remove_suffix(1);
+  return s;
+}
+
+// Next line of content starting at pos, without its line break
+std::string_view nextLine(std::string_view content, size_t& pos) {
+  const size_t end = std::min(content.find('\n', pos), content.size());
+  std::string_view line = content.substr(pos, end - pos);
+  pos = end + 1;
+  if (line.ends_with('\r')) line.remove_suffix(1);
+  return line;
+}
+
+inline QString toQString(std::string_view s) { return QString::fromUtf8(s.data(), s.size()); }
+// Same conversions as QString::toUInt() etc., without copying the field. Invalid numbers are 0.
+inline QByteArray rawBytes(std::string_view s) { return QByteArray::fromRawData(s.data(), s.size()); }
+inline uint32_t toUInt(std::string_view s) { return rawBytes(s).toUInt(); }
+inline int toInt(std::string_view s) { return rawBytes(s).toInt(); }
+inline double toDouble(std::string_view s) { return rawBytes(s).toDouble(); }
+
+// Cursor over one DBC entry. Each method consumes the longest match at the cursor and returns an
+// empty view (or false) without moving when nothing matches.
+class Tokenizer {
+ public:
+  explicit Tokenizer(std::string_view s) : s_(s) {}
+
+  inline bool atEnd() const { return pos_ >= s_.size(); }
+  inline size_t pos() const { return pos_; }
+  inline void seek(size_t pos) { pos_ = pos; }
+  inline std::string_view rest() const { return s_.substr(pos_); }
+
+  bool consume(char c) {
+    if (atEnd() || s_[pos_] != c) return false;
+    ++pos_;
+    return true;
+  }
+  bool consume(std::string_view lit) {
+    if (!rest().starts_with(lit)) return false;
+    pos_ += lit.size();
+    return true;
+  }
+  // Returns true if any whitespace was skipped (\s+), callers ignore it for \s*
+  bool skipSpace() { return !take(isSpace).empty(); }
+  std::string_view word() { return take(isWordChar); }
+  std::string_view digits() { return take(isDigit); }
+  std::string_view number() { return take(isNumberChar); }
+  // Everything up to, not including, c. Empty and unmoved if c doesn't follow.
+  std::string_view until(char c) {
+    const size_t end = s_.find(c, pos_);
+    if (end == std::string_view::npos) return {};
+    std::string_view tok = s_.substr(pos_, end - pos_);
+    pos_ = end;
+    return tok;
+  }
+
+ private:
+  std::string_view take(bool (*pred)(char)) {
+    const size_t begin = pos_;
+    while (!atEnd() && pred(s_[pos_])) ++pos_;
+    return s_.substr(begin, pos_ - begin);
+  }
+
+  std::string_view s_;
+  size_t pos_ = 0;
+};
+
+struct CommentEntry {
+  bool is_msg;
+  std::string_view address;
+  std::string_view sig_name;
+  std::string_view text;  // Still escaped
+};
+
+std::optional<CommentEntry> tokenizeComment(std::string_view entry) {
+  Tokenizer t(entry);
+  CommentEntry c;
+  if (!t.consume("CM_") || !t.skipSpace()) return std::nullopt;
+  c.is_msg = t.consume("BO_");
+  if ((!c.is_msg && !t.consume("SG_")) || !t.skipSpace()) return std::nullopt;
+  c.address = t.digits();
+  t.skipSpace();
+  c.sig_name = t.word();
+  t.skipSpace();
+  if (c.address.empty() || !t.consume('"')) return std::nullopt;
+
+  // The text ends at the last quote that is followed by the semicolon
+  const std::string_view body = t.rest();
+  for (size_t end = body.rfind('"'); end != std::string_view::npos;
+       end = end > 0 ? body.rfind('"', end - 1) : std::string_view::npos) {
+    Tokenizer tail(body.substr(end + 1));
+    tail.skipSpace();
+    if (tail.consume(';')) {
+      c.text = body.substr(0, end);
+      return c;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
 
 File::File(const QString& dbc_file_name) {
   QFile file(dbc_file_name);
   if (file.open(QIODevice::ReadOnly)) {
     name_ = QFileInfo(dbc_file_name).baseName();
     filename = dbc_file_name;
-    parse(file.readAll());
+    // Parse straight from the page cache; the mapping is released when file closes
+    const qint64 size = file.size();
+    if (const uchar* data = size > 0 ? file.map(0, size) : nullptr) {
+      parse({reinterpret_cast<const char*>(data), static_cast<size_t>(size)});
+    } else {
+      const QByteArray content = file.readAll();
+      parse({content.constData(), static_cast<size_t>(content.size())});
+    }
   } else {
     throw std::runtime_error("Failed to open file.");
   }
 }
 
-File::File(const QString& name, const QString& content) : name_(name), filename("") { parse(content); }
+File::File(const QString& name, const QString& content) : name_(name), filename("") {
+  const QByteArray utf8 = content.toUtf8();
+  parse({utf8.constData(), static_cast<size_t>(utf8.size())});
+}
 
 bool File::save() {
   assert(!filename.isEmpty());
@@ -74,46 +187,49 @@ dbc::Signal* File::signal(uint32_t address, const QString& name) {
   return m ? (dbc::Signal*)m->sig(name) : nullptr;
 }
 
-void File::parse(const QString& content) {
+void File::parse(std::string_view content) {
   msgs.clear();
 
   int line_num = 0;
-  QString line;
+  size_t pos = 0;
   dbc::Msg* current_msg = nullptr;
   int multiplexor_cnt = 0;
   bool seen_first = false;
-  QTextStream stream((QString*)&content);
 
-  while (!stream.atEnd()) {
+  while (pos < content.size()) {
     ++line_num;
-    QString raw_line = stream.readLine();
-    line = raw_line.trimmed();
+    const std::string_view raw_line = nextLine(content, pos);
+    const std::string_view line = trim(raw_line);
 
     bool seen = true;
     try {
-      if (line.startsWith("BO_ ")) {
+      if (line.starts_with("BO_ ")) {
         multiplexor_cnt = 0;
         current_msg = parseBO(line);
-      } else if (line.startsWith("SG_ ")) {
+      } else if (line.starts_with("SG_ ")) {
         parseSG(line, current_msg, multiplexor_cnt);
-      } else if (line.startsWith("VAL_ ")) {
+      } else if (line.starts_with("VAL_ ")) {
         parseVAL(line);
-      } else if (line.startsWith("CM_ BO_")) {
-        parseComment(line, stream);
-      } else if (line.startsWith("CM_ SG_ ")) {
-        parseComment(line, stream);
+      } else if (line.starts_with("CM_ BO_") || line.starts_with("CM_ SG_ ")) {
+        // Extend the entry over the following lines until one ends with the closing semicolon
+        std::string_view last = line;
+        while (!last.ends_with(';') && pos < content.size()) {
+          ++line_num;
+          last = nextLine(content, pos);
+        }
+        parseComment({line.data(), static_cast<size_t>(last.data() + last.size() - line.data())});
       } else {
         seen = false;
       }
     } catch (std::exception& e) {
       throw std::runtime_error(
-          QString("[%1:%2]%3: %4").arg(filename).arg(line_num).arg(e.what()).arg(line).toStdString());
+          QString("[%1:%2]%3: %4").arg(filename).arg(line_num).arg(e.what()).arg(toQString(line)).toStdString());
     }
 
     if (seen) {
       seen_first = true;
     } else if (!seen_first) {
-      header += raw_line + "\n";
+      header += toQString(raw_line) + "\n";
     }
   }
 
@@ -122,34 +238,75 @@ void File::parse(const QString& content) {
   }
 }
 
-dbc::Msg* File::parseBO(const QString& line) {
-  auto match = RE_MESSAGE.match(line);
-  if (!match.hasMatch()) throw std::runtime_error("Invalid BO_ line format");
+// BO_ <address> <name> *: <size> <transmitter>
+dbc::Msg* File::parseBO(std::string_view line) {
+  Tokenizer t(line);
+  t.consume("BO_ ");
+  const auto address_str = t.word();
+  const auto name = t.consume(' ') ? t.word() : std::string_view{};
+  while (t.consume(' ')) {
+  }
+  const auto size = t.consume(": ") ? t.word() : std::string_view{};
+  const auto transmitter = t.consume(' ') ? t.word() : std::string_view{};
+  if (address_str.empty() || name.empty() || size.empty() || transmitter.empty()) {
+    throw std::runtime_error("Invalid BO_ line format");
+  }
 
-  uint32_t address = match.captured("address").toUInt();
+  uint32_t address = toUInt(address_str);
   if (msgs.count(address) > 0)
     throw std::runtime_error(QString("Duplicate message address: %1").arg(address).toStdString());
 
   // Create a new message object
   dbc::Msg* msg = &msgs[address];
   msg->address = address;
-  msg->name = match.captured("name");
-  msg->size = match.captured("size").toULong();
-  msg->transmitter = match.captured("transmitter").trimmed();
+  msg->name = toQString(name);
+  msg->size = toUInt(size);
+  msg->transmitter = toQString(transmitter);
   return msg;
 }
 
-void File::parseSG(const QString& line, dbc::Msg* current_msg, int& multiplexor_cnt) {
+// SG_ <name> [M|m<n>] : <start>|<size>@<endian><sign> (<factor>,<offset>) [<min>|<max>] "<unit>" <receiver>
+void File::parseSG(std::string_view line, dbc::Msg* current_msg, int& multiplexor_cnt) {
   if (!current_msg) {
     throw std::runtime_error("Signal defined before any Message (BO_)");
   }
 
-  auto match = RE_SIGNAL.match(line);
-  if (!match.hasMatch()) {
+  Tokenizer t(line);
+  t.consume("SG_");
+  t.skipSpace();
+  const auto name_str = t.word();
+  t.skipSpace();
+  const auto mux = t.word();
+  t.skipSpace();
+  const bool valid_mux = mux.empty() || mux == "M" ||
+                         (mux.size() > 1 && mux[0] == 'm' && std::ranges::all_of(mux.substr(1), isDigit));
+
+  bool ok = !name_str.empty() && valid_mux && t.consume(':');
+  t.skipSpace();
+  const auto start = t.digits();
+  const auto size = t.consume('|') ? t.digits() : std::string_view{};
+  ok = ok && !start.empty() && !size.empty() && t.consume('@');
+  const char endian = t.atEnd() ? '\0' : t.rest()[0];
+  ok = ok && (t.consume('0') || t.consume('1'));
+  const char sign = t.atEnd() ? '\0' : t.rest()[0];
+  ok = ok && (t.consume('+') || t.consume('-'));
+  t.skipSpace();
+  const auto factor = t.consume('(') ? t.number() : std::string_view{};
+  const auto offset = t.consume(',') ? t.number() : std::string_view{};
+  ok = ok && !factor.empty() && !offset.empty() && t.consume(')');
+  t.skipSpace();
+  const auto min = t.consume('[') ? t.number() : std::string_view{};
+  const auto max = t.consume('|') ? t.number() : std::string_view{};
+  ok = ok && !min.empty() && !max.empty() && t.consume(']');
+  t.skipSpace();
+  // The unit runs to the last quote on the line
+  const size_t unit_begin = t.pos() + 1;
+  const size_t unit_end = line.rfind('"');
+  if (!ok || !t.consume('"') || unit_end == std::string_view::npos || unit_end < unit_begin) {
     throw std::runtime_error("Invalid SG_ line format");
   }
 
-  QString name = match.captured("name");
+  QString name = toQString(name_str);
   if (current_msg->sig(name) != nullptr) {
     throw std::runtime_error(QString("Duplicate signal name: %1").arg(name).toStdString());
   }
@@ -158,73 +315,81 @@ void File::parseSG(const QString& line, dbc::Msg* current_msg, int& multiplexor_
   s.name = name;
 
   // Handle Multiplexing logic
-  QString mux = match.captured("mux");
   if (mux == "M") {
     if (++multiplexor_cnt >= 2) {
       throw std::runtime_error("Multiple multiplexor switch signals (M) found in one message");
     }
     s.type = dbc::Signal::Type::Multiplexor;
-  } else if (mux.startsWith('m')) {
+  } else if (!mux.empty()) {
     s.type = dbc::Signal::Type::Multiplexed;
-    s.multiplex_value = mux.mid(1).toInt();
+    s.multiplex_value = toInt(mux.substr(1));
   } else {
     s.type = dbc::Signal::Type::Normal;
   }
 
   // Bit layout and Encoding
-  s.start_bit = match.captured("start").toInt();
-  s.size = match.captured("size").toInt();
-  s.is_little_endian = (match.captured("endian") == "1");
-  s.is_signed = (match.captured("sign") == "-");
+  s.start_bit = toInt(start);
+  s.size = toInt(size);
+  s.is_little_endian = (endian == '1');
+  s.is_signed = (sign == '-');
 
   // Physical range and Factor
-  s.factor = match.captured("factor").toDouble();
-  s.offset = match.captured("offset").toDouble();
-  s.min = match.captured("min").toDouble();
-  s.max = match.captured("max").toDouble();
+  s.factor = toDouble(factor);
+  s.offset = toDouble(offset);
+  s.min = toDouble(min);
+  s.max = toDouble(max);
 
   // Metadata
-  s.unit = match.captured("unit");
-  s.receiver_name = match.captured("receiver").trimmed();
+  s.unit = toQString(line.substr(unit_begin, unit_end - unit_begin));
+  s.receiver_name = toQString(trim(line.substr(unit_end + 1)));
 
   current_msg->sigs.push_back(new dbc::Signal(s));
 }
 
-void File::parseComment(const QString& line, QTextStream& stream) {
-  QString raw = line;
-  // Consume stream until the entry is closed by a semicolon
-  while (!raw.endsWith(';') && !stream.atEnd()) {
-    raw += "\n" + stream.readLine();
-  }
-
-  auto match = RE_COMMENT.match(raw);
-  if (!match.hasMatch()) return;
-
-  uint32_t addr = match.captured(2).toUInt();
-  QString comment = match.captured(4).replace("\\\"", "\"").trimmed();
-
-  if (match.captured(1) == "BO_") {
-    if (auto m = msg(addr)) m->comment = comment;
-  } else {
-    if (auto s = signal(addr, match.captured(3))) s->comment = comment;
+// CM_ BO_|SG_ <address> [<signal>] "<comment>" ;  The comment may span lines.
+void File::parseComment(std::string_view entry) {
+  // Like a regex search, an entry that doesn't match falls through to the next CM_ it swallowed
+  for (size_t at = 0; at != std::string_view::npos; at = entry.find("CM_", at + 1)) {
+    if (auto c = tokenizeComment(entry.substr(at))) {
+      QString comment = toQString(c->text).replace("\r\n", "\n").replace("\\\"", "\"").trimmed();
+      if (c->is_msg) {
+        if (auto m = msg(toUInt(c->address))) m->comment = comment;
+      } else {
+        if (auto s = signal(toUInt(c->address), toQString(c->sig_name))) s->comment = comment;
+      }
+      return;
+    }
   }
 }
 
-void File::parseVAL(const QString& line) {
-  auto header_match = RE_VALUE_HEADER.match(line);
-  if (!header_match.hasMatch()) return;
-
-  uint32_t addr = header_match.captured(1).toUInt();
-  QString sig_name = header_match.captured(2);
+// VAL_ <address> <signal> (<value> "<description>")* ;
+void File::parseVAL(std::string_view line) {
+  std::string_view addr, sig_name;
+  for (size_t at = 0; sig_name.empty() && at != std::string_view::npos; at = line.find("VAL_", at + 1)) {
+    Tokenizer t(line.substr(at));
+    t.consume("VAL_");
+    if (t.skipSpace() && !(addr = t.digits()).empty() && t.skipSpace()) sig_name = t.word();
+  }
+  if (sig_name.empty()) return;
 
-  if (auto s = signal(addr, sig_name)) {
+  if (auto s = signal(toUInt(addr), toQString(sig_name))) {
     s->value_table.clear();
 
-    // Iterate through all matches in the line
-    auto it = RE_VALUE_PAIR.globalMatch(line);
-    while (it.hasNext()) {
-      auto match = it.next();
-      s->value_table.push_back({match.captured(1).toDouble(), match.captured(2)});
+    // Every -?\d+\s+"[^"]*" pair on the line
+    Tokenizer t(line);
+    while (!t.atEnd()) {
+      const size_t begin = t.pos();
+      t.consume('-');
+      const bool has_digits = !t.digits().empty();
+      const std::string_view value = line.substr(begin, t.pos() - begin);
+      if (has_digits && t.skipSpace() && t.consume('"')) {
+        const auto desc = t.until('"');
+        if (t.consume('"')) {
+          s->value_table.push_back({toDouble(value), toQString(desc)});
+          continue;
+        }
+      }
+      t.seek(begin + 1);
     }
   }
 }
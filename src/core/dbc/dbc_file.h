@@ -1,7 +1,7 @@
 #pragma once
 
-#include <QTextStream>
 #include <map>
+#include <string_view>
 
 #include "dbc_message.h"
 
@@ -33,11 +33,13 @@ class File {
   QString filename;
 
  private:
-  void parse(const QString& content);
-  dbc::Msg* parseBO(const QString& line);
-  void parseSG(const QString& line, dbc::Msg* current_msg, int& multiplexor_cnt);
-  void parseComment(const QString& line, QTextStream& stream);
-  void parseVAL(const QString& line);
+  // Single pass over the raw file. Lines and fields are views into content, so only the strings
+  // stored in messages and signals are allocated.
+  void parse(std::string_view content);
+  dbc::Msg* parseBO(std::string_view line);
+  void parseSG(std::string_view line, dbc::Msg* current_msg, int& multiplexor_cnt);
+  void parseComment(std::string_view entry);
+  void parseVAL(std::string_view line);
 
   QString header;
   std::map<uint32_t, dbc::Msg> msgs;
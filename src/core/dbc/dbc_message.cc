@@ -1,7 +1,9 @@
 #include "dbc_message.h"
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
+#include <cstring>
 
 #include "dbc_manager.h"
 #include "utils/util.h"
@@ -91,6 +93,74 @@ int dbc::Msg::indexOf(const dbc::Signal* sig) const {
   return -1;
 }
 
+void dbc::Msg::parseBatch(const std::vector<const dbc::Signal*>& sig_list, const uint8_t* data, size_t stride,
+                          const uint8_t* sizes, size_t count, double* const* out) const {
+  // 8-byte window of the payload, loaded once per frame and shared by every signal inside it
+  struct Window {
+    int start;
+    bool little_endian;
+  };
+  struct Extractor {
+    double* out;
+    size_t window;
+    int shift;
+    uint64_t mask;
+    uint64_t sign_bit;  // 0 for unsigned signals
+    double factor;
+    double offset;
+    bool multiplexed;
+    uint64_t multiplex_value;
+  };
+
+  std::vector<Window> windows;
+  std::vector<Extractor> extractors;
+  bool any_multiplexed = false;
+  const bool uniform = !sizes && stride >= 8;
+  for (size_t k = 0; k < sig_list.size(); ++k) {
+    const auto* s = sig_list[k];
+    const auto& d = s->decoder_;
+    if (!uniform || !d.fast || d.end_byte > stride || (s->multiplexor && s->multiplexor != multiplexor)) {
+      s->parseBatch(data, stride, sizes, count, out[k]);
+      continue;
+    }
+
+    const Window w{std::min<int>(d.first_byte, stride - 8), s->is_little_endian};
+    auto it = std::ranges::find_if(windows, [&w](const Window& o) {
+      return o.start == w.start && o.little_endian == w.little_endian;
+    });
+    if (it == windows.end()) it = windows.insert(windows.end(), w);
+
+    extractors.push_back({out[k], size_t(it - windows.begin()),
+                          w.little_endian ? d.shift - 8 * w.start : d.shift + 8 * w.start, d.mask,
+                          s->is_signed ? 1ULL << (s->size - 1) : 0, s->factor, s->offset, s->multiplexor != nullptr,
+                          (uint64_t)s->multiplex_value});
+    any_multiplexed |= s->multiplexor != nullptr;
+  }
+  if (extractors.empty()) return;
+
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  std::vector<uint64_t> words(windows.size());
+  for (size_t i = 0; i < count; ++i, data += stride) {
+    for (size_t w = 0; w < windows.size(); ++w) {
+      uint64_t word;
+      std::memcpy(&word, data + windows[w].start, 8);
+      if (windows[w].little_endian != (std::endian::native == std::endian::little)) word = __builtin_bswap64(word);
+      words[w] = word;
+    }
+
+    const uint64_t mux = any_multiplexed ? multiplexor->decodeRaw(data, stride) : 0;
+    for (const auto& e : extractors) {
+      if (e.multiplexed && mux != e.multiplex_value) {
+        e.out[i] = nan;
+        continue;
+      }
+      const uint64_t val = (words[e.window] >> e.shift) & e.mask;
+      e.out[i] = (val & e.sign_bit) ? static_cast<int64_t>(val | ~e.mask) * e.factor + e.offset
+                                    : val * e.factor + e.offset;
+    }
+  }
+}
+
 QString dbc::Msg::newSignalName() {
   QString new_name;
   for (int i = 1; /**/; ++i) {
@@ -59,6 +59,11 @@ class Msg {
   QString newSignalName();
   void update();
   inline const std::vector<dbc::Signal*>& getSignals() const { return sigs; }
+  // Decodes sig_list, signals of this message, from count payloads spaced stride bytes apart into
+  // out[k][0, count) for sig_list[k]. sizes is as for Signal::parseBatch(). Each payload window is loaded
+  // once for all signals and the multiplexor is evaluated once per frame.
+  void parseBatch(const std::vector<const dbc::Signal*>& sig_list, const uint8_t* data, size_t stride,
+                  const uint8_t* sizes, size_t count, double* const* out) const;
 
   uint32_t address;
   QString name;
@@ -2,7 +2,9 @@
 #include "dbc_signal.h"
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
+#include <cstring>
 
 #include "utils/util.h"
 
@@ -105,7 +107,48 @@ bool dbc::Signal::operator==(const dbc::Signal& other) const {
          multiplex_value == other.multiplex_value && type == other.type && receiver_name == other.receiver_name;
 }
 
+// Loads the 8-byte window that holds the signal, clamped to the payload, and shifts the signal down.
+// Only valid when the whole signal lies within data_size.
+template <bool kLittleEndian>
+inline uint64_t dbc::Signal::extract(const uint8_t* data, size_t data_size) const {
+  uint64_t word = 0;
+  int start = 0;
+  if (data_size >= 8) {
+    start = std::min<int>(decoder_.first_byte, data_size - 8);
+    std::memcpy(&word, data + start, 8);
+  } else {
+    std::memcpy(&word, data, data_size);
+  }
+
+  if constexpr (kLittleEndian) {
+    if constexpr (std::endian::native == std::endian::big) word = __builtin_bswap64(word);
+    return (word >> (decoder_.shift - 8 * start)) & decoder_.mask;
+  } else {
+    if constexpr (std::endian::native == std::endian::little) word = __builtin_bswap64(word);
+    return (word >> (decoder_.shift + 8 * start)) & decoder_.mask;
+  }
+}
+
 uint64_t dbc::Signal::decodeRaw(const uint8_t* data, size_t data_size) const {
+  if (decoder_.fast && decoder_.end_byte <= data_size) {
+    return is_little_endian ? extract<true>(data, data_size) : extract<false>(data, data_size);
+  }
+  return decodeRawSlow(data, data_size);
+}
+
+double dbc::Signal::toPhysical(const uint8_t* data, size_t data_size) const {
+  uint64_t val = decodeRaw(data, data_size);
+
+  // Sign extension
+  if (is_signed && (val & (1ULL << (size - 1)))) {
+    val |= ~((1ULL << size) - 1);
+    return static_cast<int64_t>(val) * factor + offset;
+  }
+
+  return val * factor + offset;
+}
+
+uint64_t dbc::Signal::decodeRawSlow(const uint8_t* data, size_t data_size) const {
   const int msb_byte = msb / 8;
   if (msb_byte >= (int)data_size) return 0;
 
@@ -132,16 +175,71 @@ uint64_t dbc::Signal::decodeRaw(const uint8_t* data, size_t data_size) const {
   return val;
 }
 
-double dbc::Signal::toPhysical(const uint8_t* data, size_t data_size) const {
-  uint64_t val = decodeRaw(data, data_size);
+void dbc::Signal::updateDecoder() {
+  decoder_ = {};
+  if (size < 1 || size > 64 || msb < 0 || lsb < 0) return;
 
-  // Sign extension
-  if (is_signed && (val & (1ULL << (size - 1)))) {
-    val |= ~((1ULL << size) - 1);
-    return static_cast<int64_t>(val) * factor + offset;
+  const int msb_byte = msb / 8;
+  const int lsb_byte = lsb / 8;
+  // Bits the [msb, lsb] range spans; differs from size only for malformed signals
+  const int width = is_little_endian ? msb - lsb + 1 : (lsb_byte - msb_byte) * 8 + (msb & 7) - (lsb & 7) + 1;
+  const int first_byte = std::min(msb_byte, lsb_byte);
+  const int last_byte = std::max(msb_byte, lsb_byte);
+  if (width != size || last_byte - first_byte >= 8 || last_byte >= 64) return;
+
+  decoder_.fast = true;
+  decoder_.first_byte = first_byte;
+  decoder_.end_byte = last_byte + 1;
+  decoder_.mask = size == 64 ? ~0ULL : (1ULL << size) - 1;
+  // Little endian: bit b of the payload is bit b of the window. Big endian: byte k of the window
+  // is its (7 - k)-th most significant byte.
+  decoder_.shift = is_little_endian ? lsb : 56 - 8 * lsb_byte + (lsb & 7);
+}
+
+template <bool kLittleEndian, bool kSigned>
+void dbc::Signal::parseUniform(const uint8_t* data, size_t stride, size_t count, double* out) const {
+  // Every payload has the same length, so the load offset and shift are fixed for the whole batch
+  const int start = std::min<int>(decoder_.first_byte, stride - 8);
+  const int shift = kLittleEndian ? decoder_.shift - 8 * start : decoder_.shift + 8 * start;
+  const uint64_t mask = decoder_.mask;
+  const uint64_t sign_bit = 1ULL << (size - 1);
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+
+  data += start;
+  for (size_t i = 0; i < count; ++i, data += stride) {
+    if (multiplexor && multiplexor->decodeRaw(data - start, stride) != (uint64_t)multiplex_value) {
+      out[i] = nan;
+      continue;
+    }
+
+    uint64_t word;
+    std::memcpy(&word, data, 8);
+    if constexpr (kLittleEndian != (std::endian::native == std::endian::little)) word = __builtin_bswap64(word);
+    uint64_t val = (word >> shift) & mask;
+
+    if (kSigned && (val & sign_bit)) {
+      out[i] = static_cast<int64_t>(val | ~mask) * factor + offset;
+    } else {
+      out[i] = val * factor + offset;
+    }
   }
+}
 
-  return val * factor + offset;
+void dbc::Signal::parseBatch(const uint8_t* data, size_t stride, const uint8_t* sizes, size_t count, double* out) const {
+  if (!sizes && decoder_.fast && stride >= 8 && decoder_.end_byte <= stride) {
+    if (is_little_endian) {
+      is_signed ? parseUniform<true, true>(data, stride, count, out) : parseUniform<true, false>(data, stride, count, out);
+    } else {
+      is_signed ? parseUniform<false, true>(data, stride, count, out) : parseUniform<false, false>(data, stride, count, out);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < count; ++i, data += stride) {
+    if (!parse(data, sizes ? sizes[i] : stride, &out[i])) {
+      out[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+  }
 }
 
 void updateMsbLsb(dbc::Signal& s) {
@@ -153,4 +251,5 @@ void updateMsbLsb(dbc::Signal& s) {
     s.msb = s.start_bit;
     s.lsb = end_bit;
   }
+  s.updateDecoder();
 }
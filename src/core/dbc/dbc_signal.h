@@ -20,6 +20,11 @@ class Signal {
   double toPhysical(const uint8_t* data, size_t data_size) const;
   void update();
   bool parse(const uint8_t* data, size_t data_size, double* val) const;
+  // Decodes count payloads spaced stride bytes apart. sizes holds each payload's length, or is null
+  // when all are stride bytes long. Frames that don't carry the signal (another multiplexer value) yield NaN.
+  void parseBatch(const uint8_t* data, size_t stride, const uint8_t* sizes, size_t count, double* out) const;
+  // Recompiles the extractor used by decodeRaw(). Must follow any change to msb/lsb, size or byte order.
+  void updateDecoder();
   QString formatValue(double value, bool with_unit = true) const;
   bool operator==(const dbc::Signal& other) const;
   inline bool operator!=(const dbc::Signal& other) const { return !(*this == other); }
@@ -46,7 +51,25 @@ class Signal {
   Signal* multiplexor = nullptr;
 
  private:
+  friend class Msg;
+
+  // A signal whose bits fit in one 64-bit window is extracted with a single load, shift and mask
+  struct Decoder {
+    bool fast = false;
+    uint8_t first_byte = 0;  // Lowest byte address the signal touches
+    uint8_t end_byte = 0;    // One past the highest byte address
+    int shift = 0;           // Shift of the signal within a window loaded at byte 0
+    uint64_t mask = 0;
+  };
+
   void updateColor();
+  uint64_t decodeRawSlow(const uint8_t* data, size_t data_size) const;
+  template <bool kLittleEndian>
+  uint64_t extract(const uint8_t* data, size_t data_size) const;
+  template <bool kLittleEndian, bool kSigned>
+  void parseUniform(const uint8_t* data, size_t stride, size_t count, double* out) const;
+
+  Decoder decoder_;
 };
 }  // namespace dbc
 
@@ -1,6 +1,7 @@
 #include "abstract_stream.h"
 
 #include <QApplication>
+#include <QtConcurrent>
 #include <cstring>
 #include <limits>
 #include <utility>
@@ -8,51 +9,55 @@
 #include "common/timing.h"
 #include "modules/settings/settings.h"
 
-static constexpr int EVENT_NEXT_BUFFER_SIZE = 6 * 1024 * 1024;  // 6MB
-
-template <>
-uint64_t TimeIndex<const CanEvent*>::get_timestamp(const CanEvent* const& e) {
-  return e->mono_ns;
-}
-
 AbstractStream::AbstractStream(QObject* parent) : QObject(parent) {
   assert(parent != nullptr);
-  event_buffer_ = std::make_unique<MonotonicBuffer>(EVENT_NEXT_BUFFER_SIZE);
   snapshot_map_.reserve(1024);
-  time_index_map_.reserve(1024);
+  events_.reserve(1024);
   shared_state_.master_state.reserve(1024);
 
   connect(this, &AbstractStream::seekedTo, this, &AbstractStream::updateSnapshotsTo);
   connect(this, &AbstractStream::seeking, this, [this](double sec) { current_sec_ = sec; });
   connect(GetDBC(), &dbc::Manager::DBCFileChanged, this, &AbstractStream::updateMasks);
   connect(GetDBC(), &dbc::Manager::maskUpdated, this, &AbstractStream::updateMessageMask);
+  connect(&checkpoint_watcher_, &QFutureWatcher<void>::finished, this, [this]() {
+    if (checkpoint_watcher_.isRunning()) return;
+    // A pass stopped by the budget resumes on the coarser grid, and a finer grid fills in its gaps
+    if (trimCheckpoints() || checkpoint_over_budget_) {
+      startCheckpointBuild();
+      return;
+    }
+    // A cancelled pass is restarted by whoever stopped it
+    if (checkpoint_cancel_) return;
+
+    checkpoint_build_pending_ = false;
+    // Redo a seek that skipped replaying the gaps, now that each gap is at most one grid interval.
+    // While playing, the states have moved on and the next seek is exact.
+    if (std::exchange(seek_refine_pending_, false) && isPaused()) seekTo(current_sec_);
+  });
+}
+
+AbstractStream::~AbstractStream() {
+  stopCheckpointBuild();
 }
 
+// Copies the dirty states into their snapshots under the lock, then derives the colors without it.
+// The lock is held for one copy per dirty message.
 void AbstractStream::commitSnapshots() {
-  std::set<MessageId> msgs;
   bool structure_changed = false;
   size_t prev_src_count = sources.size();
-
   {
     std::lock_guard lk(mutex_);
     current_sec_ = shared_state_.current_sec;
-    if (shared_state_.dirty_ids.empty()) return;
-
-    for (const auto& id : shared_state_.dirty_ids) {
-      auto& state = shared_state_.master_state[id];
-      state.updateAllPatternColors(current_sec_);
-      auto& target = snapshot_map_[id];
-      if (target) {
-        target->updateFrom(state);
-      } else {
-        target = std::make_unique<MessageSnapshot>(state);
-        structure_changed = true;
-        sources.insert(id.source);
-      }
-      state.dirty = false;
-    }
-    msgs = std::move(shared_state_.dirty_ids);
+    structure_changed = publishSnapshots();
+  }
+  if (committed_.empty()) return;
+
+  std::set<MessageId> msgs;
+  for (auto& [id, snapshot] : committed_) {
+    msgs.insert(id);
+    snapshot->updateColors(current_sec_);
   }
+  committed_.clear();
 
   updateActiveStates();
 
@@ -77,6 +82,42 @@ void AbstractStream::setTimeRange(const std::optional<std::pair<double, double>>
 
 void AbstractStream::processNewMessage(const MessageId& id, uint64_t mono_ns, const uint8_t* data, uint8_t size) {
   std::lock_guard lk(mutex_);
+  updateState(id, mono_ns, data, size);
+}
+
+uint64_t AbstractStream::processNewEvents(uint64_t t0, uint64_t t1) {
+  uint64_t last_ts = 0;
+  std::lock_guard lk(mutex_);
+  forEachEvent(t0, t1, [&](const CanEvent& e) {
+    updateState({e.src, e.address}, e.mono_ns, e.dat, e.size);
+    last_ts = e.mono_ns;
+  });
+  return last_ts;
+}
+
+// Requires mutex_ to be held. Copies every state dirtied since the last commit into its snapshot and
+// lists it in committed_. Returns true if a snapshot was created.
+bool AbstractStream::publishSnapshots() {
+  bool created = false;
+  for (const auto& id : shared_state_.dirty_ids) {
+    auto& state = shared_state_.master_state[id];
+    state.resolvePatterns();
+    auto& target = snapshot_map_[id];
+    if (!target) {
+      target = std::make_unique<MessageSnapshot>();
+      created = true;
+      sources.insert(id.source);
+    }
+    target->updateFrom(state);
+    committed_.emplace_back(id, target.get());
+    state.dirty = false;
+  }
+  shared_state_.dirty_ids.clear();
+  return created;
+}
+
+// Requires mutex_ to be held
+void AbstractStream::updateState(const MessageId& id, uint64_t mono_ns, const uint8_t* data, uint8_t size) {
   const double sec = toSeconds(mono_ns);
   shared_state_.current_sec = sec;
 
@@ -88,13 +129,13 @@ void AbstractStream::processNewMessage(const MessageId& id, uint64_t mono_ns, co
 
   if (!state.dirty) {
     state.dirty = true;
-    shared_state_.dirty_ids.insert(id);
+    shared_state_.dirty_ids.push_back(id);
   }
   state.update(data, size, sec);
 }
 
-const std::vector<const CanEvent*>& AbstractStream::events(const MessageId& id) const {
-  static std::vector<const CanEvent*> empty_events;
+const MessageEvents& AbstractStream::events(const MessageId& id) const {
+  static const MessageEvents empty_events;
   auto it = events_.find(id);
   return it != events_.end() ? it->second : empty_events;
 }
@@ -105,45 +146,254 @@ const MessageSnapshot* AbstractStream::snapshot(const MessageId& id) const {
   return it != snapshot_map_.end() ? it->second.get() : &kEmptySnapshot;
 }
 
+// Restores every message to its state at sec from the nearest checkpoint, replaying only the gap.
+// Runs while the ingest side waits for the seek to finish.
 void AbstractStream::updateSnapshotsTo(double sec) {
+  stopCheckpointBuild();
   current_sec_ = sec;
 
   bool has_erased = false;
   size_t origin_snapshot_size = snapshot_map_.size();
   const uint64_t last_ts = toMonoNs(sec);
 
+  struct Restore {
+    MessageId id;
+    const MessageEvents* events;
+    size_t count;
+    MessageState* state;
+    std::vector<StateCheckpoint>* checkpoints;
+  };
+  std::vector<Restore> restores;
   for (const auto& [id, ev] : events_) {
     if (ev.empty()) continue;
 
-    auto [s_min, s_max] = time_index_map_[id].getBounds(ev.front()->mono_ns, last_ts, ev.size());
-    auto it = std::ranges::upper_bound(ev.begin() + s_min, ev.begin() + s_max, last_ts, {}, &CanEvent::mono_ns);
-    if (it == ev.begin()) {
+    const size_t count = ev.upperBound(last_ts);
+    if (count == 0) {
       has_erased |= (shared_state_.master_state.erase(id) > 0);
       has_erased |= (snapshot_map_.erase(id) > 0);
       continue;
     }
+    restores.push_back({id, &ev, count, &shared_state_.master_state[id], &checkpoints_[id]});
+  }
 
-    const CanEvent* prev_ev = *std::prev(it);
-    auto& m = shared_state_.master_state[id];
-    m.dirty = false;
-    m.init(prev_ev->dat, prev_ev->size, toSeconds(prev_ev->mono_ns));
-    m.count = std::distance(ev.begin(), it);
-    m.updateAllPatternColors(sec);  // Important: Update colors before snapshotting
-
-    auto& snap_ptr = snapshot_map_[id];
+  // Messages are independent, and each task only touches its own state and checkpoints. Until the
+  // background build has filled the grid, gaps without a checkpoint are skipped rather than replayed.
+  syncCheckpointBase();
+  const bool approximate = checkpoint_build_pending_;
+  std::atomic<bool> approximated = false;
+  QtConcurrent::blockingMap(restores, [&](const Restore& r) {
+    if (!restoreState(r.id, *r.events, r.count, *r.state, *r.checkpoints, approximate)) approximated = true;
+  });
+  seek_refine_pending_ = approximated;
+  trimCheckpoints();
+
+  for (const auto& r : restores) {
+    auto& snap_ptr = snapshot_map_[r.id];
     if (!snap_ptr) {
-      snap_ptr = std::make_unique<MessageSnapshot>(m);
+      snap_ptr = std::make_unique<MessageSnapshot>(*r.state);
     } else {
-      snap_ptr->updateFrom(m);
+      snap_ptr->updateFrom(*r.state);
     }
+    snap_ptr->updateColors(sec);
   }
 
+  // Snapshots published before the seek are stale
   shared_state_.dirty_ids.clear();
   shared_state_.seek_finished = true;
   seek_finished_cv_.notify_one();
+  startCheckpointBuild();
   emit snapshotsUpdated(nullptr, origin_snapshot_size != snapshot_map_.size() || has_erased);
 }
 
+// Returns false if the state was approximated: with `approximate`, a gap that crosses a grid point without
+// a checkpoint is not replayed. The state is then that of the nearest checkpoint, updated with the last event.
+bool AbstractStream::restoreState(const MessageId& id, const MessageEvents& events, size_t count, MessageState& state,
+                                  std::vector<StateCheckpoint>& checkpoints, bool approximate) {
+  // Replay from the checkpoint at or before count, or from the start
+  size_t pos = std::ranges::upper_bound(checkpoints, count, {}, &StateCheckpoint::index) - checkpoints.begin();
+  size_t first = 0;
+  if (pos > 0) {
+    state = checkpoints[pos - 1].state;
+    first = checkpoints[pos - 1].index;
+  } else {
+    initState(id, events, state);
+  }
+
+  const bool exact = !approximate || events.monoNs(count - 1) < gridPoint(events.monoNs(first)) + checkpoint_interval_;
+  if (exact) {
+    replayEvents(id, events, first, count, state, checkpoints, false);
+  } else {
+    const CanEvent e = events[count - 1];
+    const double ts = e.mono_ns > checkpoint_base_ ? (e.mono_ns - checkpoint_base_) / 1e9 : 0.0;
+    if (state.size != e.size) {
+      state.init(e.dat, e.size, ts);
+      applyCurrentPolicy(state, id);
+    }
+    state.update(e.dat, e.size, ts, 0, true);
+  }
+
+  state.count = count;
+  state.dirty = false;
+  state.resolvePatterns();
+  return exact;
+}
+
+// Resets state to the first event. init() keeps the suppressed bytes and ignore masks of the state.
+void AbstractStream::initState(const MessageId& id, const MessageEvents& events, MessageState& state) {
+  const CanEvent e = events.front();
+  state.init(e.dat, e.size, e.mono_ns > checkpoint_base_ ? (e.mono_ns - checkpoint_base_) / 1e9 : 0.0);
+  applyCurrentPolicy(state, id);
+}
+
+// Replays events [first, last) into state, recording a checkpoint at each grid point crossed. No checkpoint
+// may lie between first and last. A background replay stops when cancelled or over the budget.
+void AbstractStream::replayEvents(const MessageId& id, const MessageEvents& events, size_t first, size_t last,
+                                  MessageState& state, std::vector<StateCheckpoint>& checkpoints, bool background) {
+  const uint64_t base = checkpoint_base_, interval = checkpoint_interval_;
+  // The grid point at or before ts
+  auto grid = [base, interval](uint64_t ts) { return ts > base ? base + (ts - base) / interval * interval : base; };
+
+  // New checkpoints go right after the one restored from
+  size_t pos = std::ranges::upper_bound(checkpoints, first, {}, &StateCheckpoint::index) - checkpoints.begin();
+  uint64_t next_grid = grid(events.monoNs(first)) + interval;
+  auto e_it = events.begin() + first;
+  for (size_t i = first; i < last; ++i, ++e_it) {
+    if (background && checkpoint_cancel_.load(std::memory_order_relaxed)) return;
+
+    const CanEvent e = *e_it;
+    if (e.mono_ns >= next_grid) {
+      if (i > first) {
+        checkpoints.insert(checkpoints.begin() + pos++, {i, grid(e.mono_ns), state});
+        if (background && (checkpoint_bytes_ += state.memoryUsage()) > checkpoint_budget_) {
+          checkpoint_over_budget_ = true;
+          checkpoint_cancel_ = true;
+        }
+      }
+      next_grid = grid(e.mono_ns) + interval;
+    }
+
+    // Same steps as updateState()
+    const double ts = e.mono_ns > base ? (e.mono_ns - base) / 1e9 : 0.0;
+    if (state.size != e.size) {
+      state.init(e.dat, e.size, ts);
+      applyCurrentPolicy(state, id);
+    }
+    state.update(e.dat, e.size, ts);
+  }
+}
+
+// Runs on the thread pool. Replays the stretches between the checkpoints of a message that cross a grid
+// point without one, up to the last grid point before its newest event.
+void AbstractStream::fillCheckpoints(const CheckpointTask& task) {
+  const auto& events = *task.events;
+  auto& checkpoints = *task.checkpoints;
+  if (events.empty()) return;
+
+  const uint64_t base = checkpoint_base_, interval = checkpoint_interval_;
+  auto grid = [base, interval](uint64_t ts) { return ts > base ? base + (ts - base) / interval * interval : base; };
+
+  // Stretches are [bounds[k], bounds[k + 1]). The last one ends with the first event past the last grid point.
+  const size_t end = events.lowerBound(grid(events.back().mono_ns));
+  std::vector<size_t> bounds = {0};
+  for (const auto& c : checkpoints) {
+    if (c.index <= end) bounds.push_back(c.index);
+  }
+  bounds.push_back(end + 1);
+
+  for (size_t k = 0; k + 1 < bounds.size(); ++k) {
+    if (checkpoint_cancel_.load(std::memory_order_relaxed)) return;
+
+    const size_t first = bounds[k], last = bounds[k + 1];
+    if (events.monoNs(last - 1) < grid(events.monoNs(first)) + interval) continue;
+
+    MessageState state;
+    if (k == 0) {
+      {
+        std::lock_guard lk(mutex_);
+        if (auto it = shared_state_.master_state.find(task.id); it != shared_state_.master_state.end()) {
+          state = it->second;
+        }
+      }
+      initState(task.id, events, state);
+    } else {
+      state = std::ranges::lower_bound(checkpoints, first, {}, &StateCheckpoint::index)->state;
+    }
+    replayEvents(task.id, events, first, last, state, checkpoints, true);
+  }
+}
+
+// Fills in the checkpoint grid of every message on the thread pool, so the first seek does not replay
+// the route on the GUI thread
+void AbstractStream::startCheckpointBuild() {
+  stopCheckpointBuild();
+  syncCheckpointBase();
+
+  size_t usage = 0;
+  checkpoint_tasks_.clear();
+  for (const auto& [id, ev] : events_) {
+    if (ev.empty()) continue;
+    auto& checkpoints = checkpoints_[id];
+    for (const auto& c : checkpoints) usage += c.state.memoryUsage();
+    checkpoint_tasks_.push_back({id, &ev, &checkpoints});
+  }
+
+  checkpoint_budget_ = size_t(settings.seek_checkpoint_mb) * 1024 * 1024;
+  checkpoint_bytes_ = usage;
+  checkpoint_over_budget_ = false;
+  checkpoint_cancel_ = false;
+  checkpoint_build_pending_ = usage < checkpoint_budget_;
+  if (!checkpoint_build_pending_) return;
+  checkpoint_watcher_.setFuture(
+      QtConcurrent::map(checkpoint_tasks_, [this](const CheckpointTask& task) { fillCheckpoints(task); }));
+}
+
+// Checkpoints on the grid of an older route start are dropped
+void AbstractStream::syncCheckpointBase() {
+  if (const uint64_t base = beginMonoNs(); base != checkpoint_base_) {
+    checkpoints_.clear();
+    checkpoint_base_ = base;
+  }
+}
+
+void AbstractStream::stopCheckpointBuild() {
+  checkpoint_cancel_ = true;
+  checkpoint_watcher_.cancel();
+  checkpoint_watcher_.waitForFinished();
+}
+
+// Halves the checkpoint density until they fit the memory budget, and doubles it again while the doubled
+// density would use less than half of it. Returns true if the density increased.
+bool AbstractStream::trimCheckpoints() {
+  const size_t budget = size_t(settings.seek_checkpoint_mb) * 1024 * 1024;
+  auto usage = [this]() {
+    size_t total = 0;
+    for (const auto& [_, checkpoints] : checkpoints_) {
+      for (const auto& c : checkpoints) total += c.state.memoryUsage();
+    }
+    return total;
+  };
+
+  size_t total = usage();
+  while (total > budget) {
+    checkpoint_interval_ *= 2;
+    for (auto& [_, checkpoints] : checkpoints_) {
+      std::erase_if(checkpoints, [this](const StateCheckpoint& c) {
+        return (c.mono_ns - checkpoint_base_) % checkpoint_interval_ != 0;
+      });
+    }
+    total = usage();
+  }
+
+  // The existing checkpoints stay on the finer grid; the next build fills in the points between them
+  bool finer = false;
+  while (checkpoint_interval_ > kCheckpointIntervalNs && total * 4 < budget) {
+    checkpoint_interval_ /= 2;
+    total *= 2;
+    finer = true;
+  }
+  return finer;
+}
+
 void AbstractStream::updateActiveStates() {
   const double now = millis_since_boot();
   if (now - last_activity_update_ms_ > kActivityCheckIntervalMs) {
@@ -160,115 +410,99 @@ void AbstractStream::waitForSeekFinished() {
   shared_state_.seek_finished = false;
 }
 
-const CanEvent* AbstractStream::newEvent(uint64_t mono_ns, const cereal::CanData::Reader& c) {
+void AbstractStream::appendEvent(MessageEventsMap& events, uint64_t mono_ns, const cereal::CanData::Reader& c) {
+  const MessageId id(c.getSrc(), c.getAddress());
   auto dat = c.getDat();
-  CanEvent* e = (CanEvent*)event_buffer_->allocate(sizeof(CanEvent) + sizeof(uint8_t) * dat.size());
-  e->src = c.getSrc();
-  e->address = c.getAddress();
-  e->mono_ns = mono_ns;
-  e->size = dat.size();
-  memcpy(e->dat, dat.begin(), e->size);
-  return e;
+  events.try_emplace(id, id).first->second.append(mono_ns, dat.begin(), dat.size());
 }
 
-void AbstractStream::mergeEvents(const std::vector<const CanEvent*>& events) {
-  if (events.empty()) return;
-
-  // 1. Group events by ID
-  MessageEventsMap msg_events;
-  msg_events.reserve(64);
-  for (const auto* e : events) {
-    msg_events[{e->src, e->address}].push_back(e);
-  }
-
-  // Helper lambda to insert events while maintaining time order
-  auto insert_ordered = [](std::vector<const CanEvent*>& target, const std::vector<const CanEvent*>& new_evs) {
-    bool is_append = target.empty() || new_evs.front()->mono_ns >= target.back()->mono_ns;
-    target.reserve(target.size() + new_evs.size());
-
-    auto pos =
-        is_append ? target.end() : std::ranges::upper_bound(target, new_evs.front()->mono_ns, {}, &CanEvent::mono_ns);
-    target.insert(pos, new_evs.begin(), new_evs.end());
-    return is_append;
-  };
-
-  // 2. Global list update (O(1) fast-path for live streams)
-  insert_ordered(all_events_, events);
-
-  // 3. Per-ID list and Index update
-  for (auto& [id, new_e] : msg_events) {
-    auto& e = events_[id];
-    bool was_append = insert_ordered(e, new_e);
-    // Sync the time index (rebuild only if it wasn't a simple append)
-    time_index_map_[id].sync(e, e.front()->mono_ns, e.back()->mono_ns, !was_append);
+void AbstractStream::mergeEvents(MessageEventsMap&& new_events) {
+  if (new_events.empty()) return;
+  // Live streams merge every tick. The build is only restarted when it was interrupted, or when the merge
+  // inserts before existing events or extends a message past a grid point.
+  bool restart_build = checkpoint_watcher_.isRunning() || beginMonoNs() != checkpoint_base_;
+  stopCheckpointBuild();
+
+  EventRangeMap merged;
+  merged.reserve(new_events.size());
+  for (auto& [id, new_e] : new_events) {
+    if (new_e.empty()) continue;
+
+    const size_t count = new_e.size();
+    const uint64_t first_ts = new_e.front().mono_ns;
+    const uint64_t last_ts = new_e.back().mono_ns;
+    first_event_ts_ = (first_event_ts_ == 0) ? first_ts : std::min(first_event_ts_, first_ts);
+    last_event_ts_ = std::max(last_event_ts_, last_ts);
+
+    auto& e = events_.try_emplace(id, id).first->second;
+    const size_t prev_size = e.size();
+    const uint64_t prev_last_ts = e.empty() ? first_ts : e.back().mono_ns;
+    const size_t pos = e.merge(std::move(new_e));
+    if (auto it = checkpoints_.find(id); it != checkpoints_.end()) {
+      std::erase_if(it->second, [pos](const StateCheckpoint& c) { return c.index > pos; });
+    }
+    restart_build |= pos < prev_size || gridPoint(e.back().mono_ns) > gridPoint(prev_last_ts);
+    merged.emplace(id, CanEventRange(e.begin() + pos, e.begin() + pos + count));
   }
-  emit eventsMerged(msg_events);
+  if (restart_build) startCheckpointBuild();
+  emit eventsMerged(merged);
 }
 
-std::pair<CanEventIter, CanEventIter> AbstractStream::eventsInRange(
-    const MessageId& id, std::optional<std::pair<double, double>> range) const {
+CanEventRange AbstractStream::eventsInRange(const MessageId& id, std::optional<std::pair<double, double>> range) const {
   const auto& evs = events(id);
   if (evs.empty() || !range) return {evs.begin(), evs.end()};
 
-  const uint64_t t0 = toMonoNs(range->first);
-  const uint64_t t1 = toMonoNs(range->second);
-
-  auto it_index = time_index_map_.find(id);
-  if (it_index == time_index_map_.end()) {
-    return {std::ranges::lower_bound(evs, t0, {}, &CanEvent::mono_ns),
-            std::ranges::upper_bound(evs, t1, {}, &CanEvent::mono_ns)};
-  }
-
-  const auto& index = it_index->second;
-  const uint64_t start_ts = evs.front()->mono_ns;
-
-  // Narrowed search for start
-  auto [s_min, s_max] = index.getBounds(start_ts, t0, evs.size());
-  auto first = std::ranges::lower_bound(evs.begin() + s_min, evs.begin() + s_max, t0, {}, &CanEvent::mono_ns);
-
-  // Narrowed search for end
-  auto [e_min, e_max] = index.getBounds(start_ts, t1, evs.size());
-  auto search_start = std::max(first, evs.begin() + e_min);
-  auto last = std::ranges::upper_bound(search_start, evs.begin() + e_max, t1, {}, &CanEvent::mono_ns);
-  return {first, last};
+  auto [first, last] = evs.indexRange(toMonoNs(range->first), toMonoNs(range->second));
+  return {evs.begin() + first, evs.begin() + last};
 }
 
 void AbstractStream::updateMasks() {
-  std::lock_guard lk(mutex_);
+  stopCheckpointBuild();
+  {
+    std::lock_guard lk(mutex_);
 
-  shared_state_.masks.clear();
-  auto* dbc_manager = GetDBC();
+    shared_state_.masks.clear();
+    auto* dbc_manager = GetDBC();
 
-  // Rebuild the mask cache
-  for (uint8_t s : sources) {
-    for (const auto& [address, m] : dbc_manager->getMessages(s)) {
-      shared_state_.masks[{s, address}] = m.mask;
+    // Rebuild the mask cache
+    for (uint8_t s : sources) {
+      for (const auto& [address, m] : dbc_manager->getMessages(s)) {
+        shared_state_.masks[{s, address}] = m.mask;
+      }
     }
-  }
 
-  // Refresh all states based on the new cache
-  for (auto& [id, state] : shared_state_.master_state) {
-    applyCurrentPolicy(state, id);
+    // Refresh all states based on the new cache
+    for (auto& [id, state] : shared_state_.master_state) {
+      applyCurrentPolicy(state, id);
+    }
+    // Checkpoints were taken under the old masks
+    checkpoints_.clear();
   }
+  startCheckpointBuild();
 }
 
 void AbstractStream::updateMessageMask(const MessageId& id) {
   auto* dbc_manager = GetDBC();
-  std::lock_guard lk(mutex_);
+  stopCheckpointBuild();
+  {
+    std::lock_guard lk(mutex_);
 
-  for (const uint8_t s : sources) {
-    const MessageId target_id(s, id.address);
-    if (const auto* m = dbc_manager->msg(target_id)) {
-      shared_state_.masks[target_id] = m->mask;
-    } else {
-      shared_state_.masks.erase(target_id);
-    }
+    for (const uint8_t s : sources) {
+      const MessageId target_id(s, id.address);
+      if (const auto* m = dbc_manager->msg(target_id)) {
+        shared_state_.masks[target_id] = m->mask;
+      } else {
+        shared_state_.masks.erase(target_id);
+      }
 
-    auto it = shared_state_.master_state.find(target_id);
-    if (it != shared_state_.master_state.end()) {
-      applyCurrentPolicy(it->second, target_id);
+      auto it = shared_state_.master_state.find(target_id);
+      if (it != shared_state_.master_state.end()) {
+        applyCurrentPolicy(it->second, target_id);
+      }
+      checkpoints_.erase(target_id);
     }
   }
+  startCheckpointBuild();
 }
 
 void AbstractStream::applyCurrentPolicy(MessageState& state, const MessageId& id) {
@@ -289,23 +523,38 @@ void AbstractStream::suppressDefinedSignals(bool suppress) {
     if (shared_state_.mute_defined_signals == suppress) {
       return;
     }
+  }
+  // The background pass reads the policy without the lock
+  stopCheckpointBuild();
+  {
+    std::lock_guard lk(mutex_);
     shared_state_.mute_defined_signals = suppress;
   }
   updateMasks();
 }
 
 size_t AbstractStream::suppressHighlighted() {
-  std::lock_guard lk(mutex_);
+  stopCheckpointBuild();
   size_t cnt = 0;
-  for (auto& [id, m] : shared_state_.master_state) {
-    cnt += m.muteActiveBits(shared_state_.masks[id]);
+  {
+    std::lock_guard lk(mutex_);
+    for (auto& [id, m] : shared_state_.master_state) {
+      cnt += m.muteActiveBits(shared_state_.masks[id]);
+    }
+    checkpoints_.clear();
   }
+  startCheckpointBuild();
   return cnt;
 }
 
 void AbstractStream::clearSuppressed() {
-  std::lock_guard lk(mutex_);
-  for (auto& [id, m] : shared_state_.master_state) {
-    m.unmuteActiveBits(shared_state_.masks[id]);
+  stopCheckpointBuild();
+  {
+    std::lock_guard lk(mutex_);
+    for (auto& [id, m] : shared_state_.master_state) {
+      m.unmuteActiveBits(shared_state_.masks[id]);
+    }
+    checkpoints_.clear();
   }
+  startCheckpointBuild();
 }
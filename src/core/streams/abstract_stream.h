@@ -1,10 +1,13 @@
 #pragma once
 
 #include <QDateTime>
+#include <QFutureWatcher>
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <condition_variable>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -15,29 +18,21 @@
 
 #include "cereal/messaging/messaging.h"
 #include "core/dbc/dbc_manager.h"
+#include "message_events.h"
 #include "message_state.h"
 #include "replay/include/replay.h"
 #include "replay/include/util.h"
-#include "utils/time_index.h"
 #include "utils/util.h"
 
-struct CanEvent {
-  uint8_t src;
-  uint32_t address;
-  uint64_t mono_ns;
-  uint8_t size;
-  uint8_t dat[];
-};
-
-using MessageEventsMap = std::unordered_map<MessageId, std::vector<const CanEvent*>>;
-using CanEventIter = std::vector<const CanEvent*>::const_iterator;
+// Newly merged events of each message, as a range into the stream's event store
+using EventRangeMap = std::unordered_map<MessageId, CanEventRange>;
 
 class AbstractStream : public QObject {
   Q_OBJECT
 
  public:
   AbstractStream(QObject* parent);
-  virtual ~AbstractStream() = default;
+  virtual ~AbstractStream();
   virtual void start() = 0;
   virtual bool liveStreaming() const { return true; }
   virtual void seekTo(double ts) {}
@@ -51,6 +46,10 @@ class AbstractStream : public QObject {
   virtual double getSpeed() { return 1; }
   virtual bool isPaused() const { return false; }
   virtual void pause(bool pause) {}
+  // Frames discarded because the consumer fell behind the source
+  virtual uint64_t droppedFrames() const { return 0; }
+  // Messages the stream logger discarded because the disk could not keep up
+  virtual uint64_t droppedLogMessages() const { return 0; }
   void setTimeRange(const std::optional<std::pair<double, double>>& range);
   const std::optional<std::pair<double, double>>& timeRange() const { return time_range_; }
 
@@ -65,11 +64,16 @@ class AbstractStream : public QObject {
     return snapshot_map_;
   }
   inline const MessageEventsMap& eventsMap() const { return events_; }
-  inline const std::vector<const CanEvent*>& allEvents() const { return all_events_; }
   const MessageSnapshot* snapshot(const MessageId& id) const;
-  const std::vector<const CanEvent*>& events(const MessageId& id) const;
-  std::pair<CanEventIter, CanEventIter> eventsInRange(const MessageId& id,
-                                                      std::optional<std::pair<double, double>> time_range) const;
+  const MessageEvents& events(const MessageId& id) const;
+  CanEventRange eventsInRange(const MessageId& id, std::optional<std::pair<double, double>> time_range) const;
+  // Visits all events within [t0, t1] in time order, k-way merging the per-message stores
+  template <typename Fn>
+  void forEachEvent(uint64_t t0, uint64_t t1, Fn&& fn) const;
+  template <typename Fn>
+  void forEachEvent(Fn&& fn) const {
+    forEachEvent(0, std::numeric_limits<uint64_t>::max(), std::forward<Fn>(fn));
+  }
 
   size_t suppressHighlighted();
   void clearSuppressed();
@@ -81,7 +85,7 @@ class AbstractStream : public QObject {
   void seeking(double sec);
   void seekedTo(double sec);
   void timeRangeChanged(const std::optional<std::pair<double, double>>& range);
-  void eventsMerged(const MessageEventsMap& events_map);
+  void eventsMerged(const EventRangeMap& new_events);
   void snapshotsUpdated(const std::set<MessageId>* ids, bool needs_rebuild);
   void sourcesUpdated(const SourceSet& s);
   void qLogLoaded(std::shared_ptr<LogReader> qlog);
@@ -91,38 +95,84 @@ class AbstractStream : public QObject {
 
  protected:
   void commitSnapshots();
-  void mergeEvents(const std::vector<const CanEvent*>& events);
-  const CanEvent* newEvent(uint64_t mono_ns, const cereal::CanData::Reader& c);
+  void mergeEvents(MessageEventsMap&& new_events);
+  static void appendEvent(MessageEventsMap& events, uint64_t mono_ns, const cereal::CanData::Reader& c);
   void processNewMessage(const MessageId& id, uint64_t mono_ns, const uint8_t* data, uint8_t size);
+  // Applies all events within [t0, t1] under a single lock. Returns the last applied timestamp, or 0.
+  uint64_t processNewEvents(uint64_t t0, uint64_t t1);
   void waitForSeekFinished();
 
   struct SharedState {
     double current_sec = 0;
-    std::set<MessageId> dirty_ids;
+    std::vector<MessageId> dirty_ids;  // Unique, guarded by MessageState::dirty
     std::unordered_map<MessageId, MessageState> master_state;
     std::unordered_map<MessageId, std::vector<uint8_t>> masks;
     bool mute_defined_signals = false;
     bool seek_finished = false;
   };
 
-  std::vector<const CanEvent*> all_events_;
+  uint64_t first_event_ts_ = 0;  // Earliest and latest merged event timestamps
+  uint64_t last_event_ts_ = 0;
   double current_sec_ = 0;
   std::optional<std::pair<double, double>> time_range_;
 
  private:
   static constexpr double kActivityCheckIntervalMs = 1000.0;
+  static constexpr uint64_t kCheckpointIntervalNs = 10'000'000'000ULL;
+
+  // Message state after the first `index` events, taken on a grid of route time
+  struct StateCheckpoint {
+    size_t index;
+    uint64_t mono_ns;
+    MessageState state;
+  };
+
+  struct CheckpointTask {
+    MessageId id;
+    const MessageEvents* events;
+    std::vector<StateCheckpoint>* checkpoints;
+  };
 
+  bool publishSnapshots();
   void updateSnapshotsTo(double sec);
+  bool restoreState(const MessageId& id, const MessageEvents& events, size_t count, MessageState& state,
+                    std::vector<StateCheckpoint>& checkpoints, bool approximate);
+  void initState(const MessageId& id, const MessageEvents& events, MessageState& state);
+  void replayEvents(const MessageId& id, const MessageEvents& events, size_t first, size_t last, MessageState& state,
+                    std::vector<StateCheckpoint>& checkpoints, bool background);
+  void fillCheckpoints(const CheckpointTask& task);
+  void startCheckpointBuild();
+  void stopCheckpointBuild();
+  void syncCheckpointBase();
+  bool trimCheckpoints();
+  // The grid point at or before ts
+  inline uint64_t gridPoint(uint64_t ts) const {
+    if (ts <= checkpoint_base_) return checkpoint_base_;
+    return checkpoint_base_ + (ts - checkpoint_base_) / checkpoint_interval_ * checkpoint_interval_;
+  }
+  void updateState(const MessageId& id, uint64_t mono_ns, const uint8_t* data, uint8_t size);
   void updateMasks();
   void updateActiveStates();
   void updateMessageMask(const MessageId& id);
   void applyCurrentPolicy(MessageState& state, const MessageId& id);
 
   std::unordered_map<MessageId, std::unique_ptr<MessageSnapshot>> snapshot_map_;
+  // Snapshots updated by publishSnapshots(), colored once the lock is released
+  std::vector<std::pair<MessageId, MessageSnapshot*>> committed_;
+  std::unordered_map<MessageId, std::vector<StateCheckpoint>> checkpoints_;
+  uint64_t checkpoint_base_ = 0;
+  uint64_t checkpoint_interval_ = kCheckpointIntervalNs;  // Doubled over the budget, halved when there is room
+  // Background pass filling in the grid. Stopped before anything touches events_ or checkpoints_.
+  std::vector<CheckpointTask> checkpoint_tasks_;
+  QFutureWatcher<void> checkpoint_watcher_;
+  std::atomic<bool> checkpoint_cancel_ = false;
+  std::atomic<bool> checkpoint_over_budget_ = false;
+  std::atomic<size_t> checkpoint_bytes_ = 0;
+  size_t checkpoint_budget_ = 0;
+  bool checkpoint_build_pending_ = false;  // A build is scheduled and has not finished
+  bool seek_refine_pending_ = false;       // The last seek restored some states approximately
 
   MessageEventsMap events_;
-  std::unique_ptr<MonotonicBuffer> event_buffer_;
-  std::unordered_map<MessageId, TimeIndex<const CanEvent*>> time_index_map_;
 
   double last_activity_update_ms_ = 0;
   std::mutex mutex_;
@@ -130,6 +180,38 @@ class AbstractStream : public QObject {
   std::condition_variable seek_finished_cv_;
 };
 
+template <typename Fn>
+void AbstractStream::forEachEvent(uint64_t t0, uint64_t t1, Fn&& fn) const {
+  struct Cursor {
+    CanEventIter it, end;
+    MessageId id;
+  };
+
+  std::vector<Cursor> heap;
+  heap.reserve(events_.size());
+  for (const auto& [id, evs] : events_) {
+    auto [first, last] = evs.indexRange(t0, t1);
+    if (first < last) heap.push_back({evs.begin() + first, evs.begin() + last, id});
+  }
+
+  // Min-heap on timestamp; ties are broken by MessageId to keep the order deterministic
+  auto later = [](const Cursor& a, const Cursor& b) {
+    const uint64_t ta = a.it.monoNs(), tb = b.it.monoNs();
+    return ta != tb ? ta > tb : a.id > b.id;
+  };
+  std::ranges::make_heap(heap, later);
+  while (!heap.empty()) {
+    std::ranges::pop_heap(heap, later);
+    auto& c = heap.back();
+    fn(*c.it);
+    if (++c.it != c.end) {
+      std::ranges::push_heap(heap, later);
+    } else {
+      heap.pop_back();
+    }
+  }
+}
+
 class DummyStream : public AbstractStream {
   Q_OBJECT
  public:
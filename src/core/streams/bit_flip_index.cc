@@ -0,0 +1,112 @@
+#include "core/streams/bit_flip_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+
+// Compares cur with the last value of each byte and calls fn(byte, 7 - bit) for every flipped bit,
+// then records cur's bytes. seen counts the leading bytes carried by any frame so far.
+template <typename Fn>
+inline void applyFrame(uint8_t* last, size_t& seen, const CanEvent& cur, size_t bytes, Fn&& fn) {
+  const size_t n = std::min<size_t>(cur.size, bytes);
+  for (size_t i = 0; i < std::min(n, seen); ++i) {
+    for (unsigned diff = last[i] ^ cur.dat[i]; diff; diff &= diff - 1) {
+      fn(i, 7 - std::countr_zero(diff));
+    }
+  }
+  std::memcpy(last, cur.dat, n);
+  seen = std::max(seen, n);
+}
+
+}  // namespace
+
+void BitFlipIndex::sync(const MessageEvents& events) {
+  size_t bytes = 0;
+  for (const auto& chunk : events.chunks()) bytes = std::max<size_t>(bytes, chunk.stride());
+  if (events.size() == size_ && bytes == bytes_) return;
+
+  // Keep the checkpoints whose events still sit at the same index
+  size_t valid = 0;
+  if (bytes == bytes_) {
+    const size_t n = std::min(mono_ns_.size(), events.empty() ? 0 : (events.size() - 1) / kInterval + 1);
+    while (valid < n && events.monoNs(valid * kInterval) == mono_ns_[valid]) ++valid;
+  }
+
+  const size_t stride = bytes * 8;
+  bytes_ = bytes;
+  size_ = events.size();
+  mono_ns_.resize(valid);
+  counts_.resize(valid * stride);
+  last_.resize(valid * bytes);
+  seen_.resize(valid);
+  if (events.empty()) return;
+
+  if (valid == 0) {
+    const CanEvent first = *events.begin();
+    size_t seen = 0;
+    last_.resize(bytes, 0);
+    applyFrame(last_.data(), seen, first, bytes, [](size_t, int) {});
+    mono_ns_.push_back(first.mono_ns);
+    counts_.resize(stride, 0);
+    seen_.push_back(seen);
+    valid = 1;
+  }
+
+  std::vector<uint32_t> running(counts_.end() - stride, counts_.end());
+  std::vector<uint8_t> last(last_.end() - bytes, last_.end());
+  size_t seen = seen_.back();
+  const size_t last_checkpoint = (size_ - 1) / kInterval * kInterval;
+  auto it = events.begin() + (valid - 1) * kInterval;
+  for (size_t i = it.index() + 1; i <= last_checkpoint; ++i) {
+    const CanEvent cur = *++it;
+    applyFrame(last.data(), seen, cur, bytes_, [&](size_t byte, int col) { ++running[byte * 8 + col]; });
+    if (i % kInterval == 0) {
+      mono_ns_.push_back(cur.mono_ns);
+      counts_.insert(counts_.end(), running.begin(), running.end());
+      last_.insert(last_.end(), last.begin(), last.end());
+      seen_.push_back(seen);
+    }
+  }
+}
+
+void BitFlipIndex::count(const MessageEvents& events, size_t first, size_t last, size_t msg_size,
+                         BitFlipCounts& out) const {
+  out.fill({});
+  if (last <= first + 1 || last > size_) return;
+
+  // Unsigned wrap-around cancels out, as the prefix at last - 1 is never below the one at first
+  accumulate(events, last - 1, 1, msg_size, out);
+  accumulate(events, first, -1, msg_size, out);
+}
+
+void BitFlipIndex::accumulate(const MessageEvents& events, size_t i, int sign, size_t msg_size,
+                              BitFlipCounts& out) const {
+  const size_t bytes = std::min<size_t>({bytes_, msg_size, MAX_CAN_LEN});
+  const size_t k = i / kInterval;
+  const uint32_t* base = counts_.data() + k * bytes_ * 8;
+  for (size_t byte = 0; byte < bytes; ++byte) {
+    for (int col = 0; col < 8; ++col) out[byte][col] += sign * base[byte * 8 + col];
+  }
+
+  // Every byte is replayed so the last values stay exact; only the first msg_size are counted
+  std::array<uint8_t, MAX_CAN_LEN> last = {};
+  std::copy_n(last_.begin() + k * bytes_, std::min<size_t>(bytes_, MAX_CAN_LEN), last.begin());
+  size_t seen = seen_[k];
+  auto it = events.begin() + k * kInterval;
+  for (size_t j = it.index(); j < i; ++j) {
+    const CanEvent cur = *++it;
+    applyFrame(last.data(), seen, cur, std::min<size_t>(bytes_, MAX_CAN_LEN), [&](size_t byte, int col) {
+      if (byte < bytes) out[byte][col] += sign;
+    });
+  }
+}
+
+void BitFlipIndex::clear() {
+  bytes_ = size_ = 0;
+  mono_ns_.clear();
+  counts_.clear();
+  last_.clear();
+  seen_.clear();
+}
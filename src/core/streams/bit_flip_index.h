@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "core/streams/message_events.h"
+#include "core/streams/message_state.h"
+
+// Flip count of every bit, indexed [byte][7 - bit] like the binary view columns
+using BitFlipCounts = std::array<std::array<uint32_t, 8>, MAX_CAN_LEN>;
+
+/**
+ * @brief Cumulative bit-flip counters of one message, sampled every kInterval events.
+ * The flips within an event range are the difference of two prefix counts, and each prefix is
+ * a checkpoint plus a scan of fewer than kInterval events, so a query costs the same for a
+ * second of data as for the whole route. A flip is a bit that differs from the last value seen
+ * for its byte, so bytes missing from shorter frames are compared against the latest frame that
+ * carried them. A byte's first appearance is not a flip.
+ */
+class BitFlipIndex {
+ public:
+  static constexpr size_t kInterval = 1024;
+
+  // Brings the checkpoints in step with events. Only checkpoints past the first event that
+  // moved (e.g. after a segment merged in front of it) are recomputed.
+  void sync(const MessageEvents& events);
+  // Flips between consecutive events of [first, last), for bytes below msg_size.
+  // events must be the container passed to the last sync().
+  void count(const MessageEvents& events, size_t first, size_t last, size_t msg_size, BitFlipCounts& out) const;
+  void clear();
+  inline size_t size() const { return size_; }
+
+ private:
+  // Adds (sign > 0) or subtracts the flips of all transitions up to and including event i
+  void accumulate(const MessageEvents& events, size_t i, int sign, size_t msg_size, BitFlipCounts& out) const;
+
+  size_t bytes_ = 0;  // Counters per checkpoint are bytes_ * 8
+  size_t size_ = 0;   // Events covered by the last sync()
+  std::vector<uint64_t> mono_ns_;  // Time of the event at each checkpoint, to detect shifted indices
+  std::vector<uint32_t> counts_;   // Flips up to each checkpoint event, bytes_ * 8 per checkpoint
+  std::vector<uint8_t> last_;      // Last value of each byte at each checkpoint, bytes_ per checkpoint
+  std::vector<uint8_t> seen_;      // Bytes carried by any frame up to each checkpoint
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Bit counters of one 8-byte payload block, indexed [bit][byte in block] with bits MSB first,
+// so one bit of every byte in the block is a single row of 8 lanes.
+struct BitStats {
+  std::array<std::array<uint32_t, 8>, 8> flips = {};
+  std::array<std::array<uint32_t, 8>, 8> highs = {};
+
+  inline uint32_t flipCount(int byte, int bit) const { return flips[bit][byte]; }
+  inline uint32_t highCount(int byte, int bit) const { return highs[bit][byte]; }
+  void clearByte(int byte) {
+    for (int bit = 0; bit < 8; ++bit) flips[bit][byte] = highs[bit][byte] = 0;
+  }
+};
+
+namespace bit_stats {
+
+// 0x01 in every byte of `diff` that has any bit set
+inline uint64_t changedLanes(uint64_t diff) {
+  diff |= diff >> 4;
+  diff |= diff >> 2;
+  diff |= diff >> 1;
+  return diff & 0x0101010101010101ULL;
+}
+
+// Adds, for every byte of the block that changed, its bits in `cur` to the high counts and its bits
+// in `diff` to the flip counts. Bytes are little endian in the words, as copied from the payload.
+inline void accumulateScalar(BitStats& s, uint64_t cur, uint64_t diff) {
+  const uint64_t lanes = changedLanes(diff);
+  for (int bit = 0; bit < 8; ++bit) {
+    const uint64_t h = (cur >> (7 - bit)) & lanes;
+    const uint64_t f = (diff >> (7 - bit)) & lanes;
+    for (int byte = 0; byte < 8; ++byte) {
+      s.highs[bit][byte] += (h >> (byte * 8)) & 1;
+      s.flips[bit][byte] += (f >> (byte * 8)) & 1;
+    }
+  }
+}
+
+// Same as accumulateScalar(), widening each row of 8 lane bits into 32-bit counters at once
+inline void accumulate(BitStats& s, uint64_t cur, uint64_t diff) {
+#if defined(__AVX2__)
+  const uint64_t lanes = changedLanes(diff);
+  for (int bit = 0; bit < 8; ++bit) {
+    const __m256i h = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((cur >> (7 - bit)) & lanes));
+    const __m256i f = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((diff >> (7 - bit)) & lanes));
+    auto* hc = reinterpret_cast<__m256i*>(s.highs[bit].data());
+    auto* fc = reinterpret_cast<__m256i*>(s.flips[bit].data());
+    _mm256_storeu_si256(hc, _mm256_add_epi32(_mm256_loadu_si256(hc), h));
+    _mm256_storeu_si256(fc, _mm256_add_epi32(_mm256_loadu_si256(fc), f));
+  }
+#elif defined(__SSE2__)
+  const uint64_t lanes = changedLanes(diff);
+  const __m128i zero = _mm_setzero_si128();
+  auto add_row = [&](uint32_t* counters, uint64_t row) {
+    const __m128i w = _mm_unpacklo_epi8(_mm_cvtsi64_si128(row), zero);
+    auto* c = reinterpret_cast<__m128i*>(counters);
+    _mm_storeu_si128(c, _mm_add_epi32(_mm_loadu_si128(c), _mm_unpacklo_epi16(w, zero)));
+    _mm_storeu_si128(c + 1, _mm_add_epi32(_mm_loadu_si128(c + 1), _mm_unpackhi_epi16(w, zero)));
+  };
+  for (int bit = 0; bit < 8; ++bit) {
+    add_row(s.highs[bit].data(), (cur >> (7 - bit)) & lanes);
+    add_row(s.flips[bit].data(), (diff >> (7 - bit)) & lanes);
+  }
+#elif defined(__ARM_NEON)
+  const uint64_t lanes = changedLanes(diff);
+  auto add_row = [](uint32_t* counters, uint64_t row) {
+    const uint16x8_t w = vmovl_u8(vcreate_u8(row));
+    vst1q_u32(counters, vaddq_u32(vld1q_u32(counters), vmovl_u16(vget_low_u16(w))));
+    vst1q_u32(counters + 4, vaddq_u32(vld1q_u32(counters + 4), vmovl_u16(vget_high_u16(w))));
+  };
+  for (int bit = 0; bit < 8; ++bit) {
+    add_row(s.highs[bit].data(), (cur >> (7 - bit)) & lanes);
+    add_row(s.flips[bit].data(), (diff >> (7 - bit)) & lanes);
+  }
+#else
+  accumulateScalar(s, cur, diff);
+#endif
+}
+
+}  // namespace bit_stats
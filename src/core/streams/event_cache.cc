@@ -0,0 +1,240 @@
+#include "event_cache.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#include "message_state.h"
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'A', 'B', 'I', 'D', 'X', '\0', '\0'};
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_count;
+  EventCache::Fingerprint fingerprint;
+};
+
+// One record per chunk. Followed by the timestamp, data, sizes and index columns,
+// each padded to 8 bytes.
+struct ChunkRecord {
+  uint32_t address;
+  uint8_t src;
+  uint8_t stride;
+  uint8_t has_sizes;
+  uint8_t reserved;
+  uint64_t count;
+  uint64_t index_count;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(ChunkRecord) % 8 == 0);
+
+inline size_t padded(size_t n) { return (n + 7) & ~size_t(7); }
+
+class Reader {
+ public:
+  Reader(const uchar* data, qint64 size) : data_(data), size_(size) {}
+  template <class T>
+  const T* take(size_t count = 1) {
+    if (count > (size_ - pos_) / sizeof(T)) return nullptr;
+    const size_t bytes = sizeof(T) * count;
+    auto p = reinterpret_cast<const T*>(data_ + pos_);
+    pos_ += std::min(padded(bytes), size_ - pos_);
+    return p;
+  }
+  inline bool atEnd() const { return pos_ == size_; }
+  inline size_t remaining() const { return size_ - pos_; }
+
+ private:
+  const uchar* data_;
+  size_t size_;
+  size_t pos_ = 0;
+};
+
+// Timestamps must ascend within the fingerprint's range, and the buckets must be exactly what
+// TimeIndex::sync builds for them, or lookups leave the chunk.
+bool validTimestamps(const uint64_t* ts, size_t count, const uint64_t* buckets, size_t bucket_count,
+                     const EventCache::Fingerprint& fingerprint) {
+  size_t sec = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (ts[i] < fingerprint.first_mono_ns || ts[i] > fingerprint.last_mono_ns) return false;
+    if (i > 0 && ts[i] < ts[i - 1]) return false;
+    if (bucket_count == 0) continue;
+
+    for (const uint64_t s = (ts[i] - ts[0]) / 1'000'000'000; sec <= s; ++sec) {
+      if (sec >= bucket_count || buckets[sec] != i) return false;
+    }
+  }
+  return bucket_count == 0 || sec == bucket_count;
+}
+
+void writePadded(QSaveFile& f, const void* data, size_t bytes) {
+  static const char zeros[8] = {};
+  if (bytes > 0) f.write(reinterpret_cast<const char*>(data), bytes);
+  if (size_t pad = padded(bytes) - bytes) f.write(zeros, pad);
+}
+
+}  // namespace
+
+QString EventCache::rootPath() {
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/can_index";
+}
+
+QString EventCache::routePath(const QString& route) {
+  QString route_dir = route;
+  route_dir.replace('|', '_').replace('/', '_');
+  return QString("%1/%2").arg(rootPath(), route_dir);
+}
+
+QString EventCache::filePath(const QString& route, int segment) {
+  return QString("%1/%2.cabana-index").arg(routePath(route)).arg(segment);
+}
+
+std::optional<MessageEventsMap> EventCache::load(const QString& route, int segment, const Fingerprint& fingerprint) {
+  QFile file(filePath(route, segment));
+  if (!file.open(QIODevice::ReadOnly)) return std::nullopt;
+
+  uchar* mapped = file.map(0, file.size());
+  if (!mapped) return std::nullopt;
+
+  auto events = parse(mapped, file.size(), fingerprint);
+  file.unmap(mapped);
+  if (!events) {
+    // Stale or corrupt. The segment is decoded and saved again.
+    file.remove();
+    return std::nullopt;
+  }
+  // The modification time orders files for eviction
+  file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+  return events;
+}
+
+// Checks every field against the mapped size before it is used; any mismatch rejects the whole file
+std::optional<MessageEventsMap> EventCache::parse(const uchar* mapped, qint64 size, const Fingerprint& fingerprint) {
+  Reader reader(mapped, size);
+  auto header = reader.take<FileHeader>();
+  if (!header || std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion ||
+      header->fingerprint != fingerprint || header->record_count > reader.remaining() / sizeof(ChunkRecord)) {
+    return std::nullopt;
+  }
+
+  MessageEventsMap events;
+  events.reserve(header->record_count);
+  std::unordered_map<MessageId, uint64_t> last_ts;  // Chunks of a message follow each other in time
+  for (uint32_t r = 0; r < header->record_count; ++r) {
+    auto rec = reader.take<ChunkRecord>();
+    if (!rec || rec->count == 0 || rec->stride == 0 || rec->stride > MAX_CAN_LEN || rec->has_sizes > 1) {
+      return std::nullopt;
+    }
+
+    auto mono_ns = reader.take<uint64_t>(rec->count);
+    auto data = mono_ns ? reader.take<uint8_t>(rec->count * rec->stride) : nullptr;
+    auto sizes = rec->has_sizes ? reader.take<uint8_t>(rec->count) : nullptr;
+    auto buckets = reader.take<uint64_t>(rec->index_count);
+    if (!mono_ns || !data || (rec->has_sizes && !sizes) || (rec->index_count > 0 && !buckets)) return std::nullopt;
+    if (sizes && std::any_of(sizes, sizes + rec->count, [&](uint8_t s) { return s > rec->stride; })) {
+      return std::nullopt;
+    }
+    if (!validTimestamps(mono_ns, rec->count, buckets, rec->index_count, fingerprint)) return std::nullopt;
+
+    MessageId id(rec->src, rec->address);
+    auto [it, inserted] = last_ts.try_emplace(id, mono_ns[rec->count - 1]);
+    if (!inserted) {
+      if (mono_ns[0] < it->second) return std::nullopt;
+      it->second = mono_ns[rec->count - 1];
+    }
+
+    // The store owns its columns, so they are copied out of the mapping
+    MessageEvents::Chunk chunk;
+    chunk.stride_ = rec->stride;
+    chunk.mono_ns_.assign(mono_ns, mono_ns + rec->count);
+    chunk.data_.assign(data, data + rec->count * rec->stride);
+    if (sizes) chunk.sizes_.assign(sizes, sizes + rec->count);
+    chunk.time_index_.restore(std::vector<size_t>(buckets, buckets + rec->index_count));
+    events.try_emplace(id, id).first->second.mergeChunk(std::move(chunk));
+  }
+  if (!reader.atEnd()) return std::nullopt;
+  return events;
+}
+
+bool EventCache::save(const QString& route, int segment, const Fingerprint& fingerprint,
+                      const MessageEventsMap& events) {
+  const QString path = filePath(route, segment);
+  if (!QDir().mkpath(QFileInfo(path).absolutePath())) return false;
+
+  FileHeader header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.fingerprint = fingerprint;
+  for (const auto& [_, e] : events) {
+    header.record_count += e.chunks().size();
+  }
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) return false;
+
+  writePadded(file, &header, sizeof(header));
+  for (const auto& [id, e] : events) {
+    for (const auto& c : e.chunks()) {
+      const auto& index = c.time_index_.buckets();
+      ChunkRecord rec = {
+          .address = id.address,
+          .src = id.source,
+          .stride = c.stride_,
+          .has_sizes = !c.sizes_.empty(),
+          .reserved = 0,
+          .count = c.size(),
+          .index_count = index.size(),
+      };
+      writePadded(file, &rec, sizeof(rec));
+      writePadded(file, c.mono_ns_.data(), c.mono_ns_.size() * sizeof(uint64_t));
+      writePadded(file, c.data_.data(), c.data_.size());
+      if (rec.has_sizes) writePadded(file, c.sizes_.data(), c.sizes_.size());
+      const std::vector<uint64_t> buckets(index.begin(), index.end());
+      writePadded(file, buckets.data(), buckets.size() * sizeof(uint64_t));
+    }
+  }
+  return file.commit();
+}
+
+void EventCache::evict(uint64_t max_bytes, const QString& keep_route) {
+  static std::mutex mutex;
+  std::lock_guard lk(mutex);
+
+  struct Entry {
+    qint64 mtime;
+    uint64_t size;
+    QString path;
+  };
+  std::vector<Entry> files;
+  uint64_t total = 0;
+  QDirIterator it(rootPath(), {"*.cabana-index"}, QDir::Files, QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    it.next();
+    const QFileInfo info = it.fileInfo();
+    files.push_back({info.lastModified().toMSecsSinceEpoch(), uint64_t(info.size()), info.absoluteFilePath()});
+    total += info.size();
+  }
+  if (total <= max_bytes) return;
+
+  std::ranges::sort(files, {}, &Entry::mtime);
+  const QString keep_dir = keep_route.isEmpty() ? QString() : QFileInfo(routePath(keep_route)).absoluteFilePath();
+  for (const auto& f : files) {
+    if (total <= max_bytes) break;
+    if (QFileInfo(f.path).absolutePath() == keep_dir || !QFile::remove(f.path)) continue;
+    total -= f.size;
+    // Drop the route directory with its last segment
+    QDir().rmdir(QFileInfo(f.path).absolutePath());
+  }
+}
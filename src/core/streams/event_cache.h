@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QString>
+#include <optional>
+
+#include "message_events.h"
+
+/**
+ * @brief Persistent cache of decoded CAN events for replay segments.
+ * Each segment is stored in its own `<segment>.cabana-index` file under a per-route
+ * cache directory. A file holds the event columns of every message in the segment,
+ * together with the chunk time index buckets. Replay still loads and parses the rlog,
+ * but reopening a route copies the columns from the mapped file instead of walking every
+ * CAN event through capnp and rebuilding the time index.
+ * Loading a file refreshes its modification time, and evict() removes the least
+ * recently used files once the cache exceeds its byte budget.
+ */
+class EventCache {
+ public:
+  // Identifies the log content a cache file was built from; mismatching files are removed.
+  struct Fingerprint {
+    uint64_t can_events = 0;
+    uint64_t first_mono_ns = 0;
+    uint64_t last_mono_ns = 0;
+    bool operator==(const Fingerprint& other) const = default;
+  };
+
+  static QString filePath(const QString& route, int segment);
+  static std::optional<MessageEventsMap> load(const QString& route, int segment, const Fingerprint& fingerprint);
+  static bool save(const QString& route, int segment, const Fingerprint& fingerprint, const MessageEventsMap& events);
+  // Removes the least recently used files until the cache holds at most max_bytes. Files of keep_route
+  // are never removed. Scans the whole cache, so call it once per batch of saves; calls are serialized.
+  static void evict(uint64_t max_bytes, const QString& keep_route = {});
+
+ private:
+  static QString rootPath();
+  static QString routePath(const QString& route);
+  static std::optional<MessageEventsMap> parse(const uchar* mapped, qint64 size, const Fingerprint& fingerprint);
+};
@@ -1,38 +1,238 @@
 #include "live_stream.h"
 
+#include <bzlib.h>
+#include <zstd.h>
+
 #include <QThread>
 #include <QTimerEvent>
+#include <QtConcurrent>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <memory>
+#include <thread>
 
 #include "common/timing.h"
 #include "common/util.h"
 #include "modules/settings/settings.h"
 
+namespace {
+
+bool compressZstd(std::istream& in, std::ostream& out) {
+  std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx(ZSTD_createCCtx(), ZSTD_freeCCtx);
+  if (!cctx) return false;
+  ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_compressionLevel, 10);
+
+  std::vector<char> in_buf(ZSTD_CStreamInSize()), out_buf(ZSTD_CStreamOutSize());
+  while (true) {
+    in.read(in_buf.data(), in_buf.size());
+    const size_t n = in.gcount();
+    const bool last = n < in_buf.size();
+    ZSTD_inBuffer input = {in_buf.data(), n, 0};
+    bool finished = false;
+    while (!finished) {
+      ZSTD_outBuffer output = {out_buf.data(), out_buf.size(), 0};
+      const size_t remaining = ZSTD_compressStream2(cctx.get(), &output, &input, last ? ZSTD_e_end : ZSTD_e_continue);
+      if (ZSTD_isError(remaining)) return false;
+      out.write(out_buf.data(), output.pos);
+      finished = last ? remaining == 0 : input.pos == input.size;
+    }
+    if (last) return true;
+  }
+}
+
+bool compressBz2(std::istream& in, std::ostream& out) {
+  bz_stream strm = {};
+  if (BZ2_bzCompressInit(&strm, 9, 0, 30) != BZ_OK) return false;
+
+  std::vector<char> in_buf(1 << 20), out_buf(1 << 20);
+  bool ok = true;
+  for (bool last = false; ok && !last;) {
+    in.read(in_buf.data(), in_buf.size());
+    const size_t n = in.gcount();
+    last = n < in_buf.size();
+    strm.next_in = in_buf.data();
+    strm.avail_in = n;
+    int ret = BZ_RUN_OK;
+    do {
+      strm.next_out = out_buf.data();
+      strm.avail_out = out_buf.size();
+      ret = BZ2_bzCompress(&strm, last ? BZ_FINISH : BZ_RUN);
+      if (ret < 0) {
+        ok = false;
+        break;
+      }
+      out.write(out_buf.data(), out_buf.size() - strm.avail_out);
+    } while (last ? ret != BZ_STREAM_END : strm.avail_in > 0);
+  }
+  BZ2_bzCompressEnd(&strm);
+  return ok;
+}
+
+// Compresses a finished segment next to the original and removes the original on success
+void compressSegment(const std::string& path, Settings::LogCompression method) {
+  const bool zstd = method == Settings::LogZstd;
+  const std::string out_path = path + (zstd ? ".zst" : ".bz2");
+  std::ifstream in(path, std::ios::binary);
+  std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+  bool ok = in && out && (zstd ? compressZstd(in, out) : compressBz2(in, out));
+  out.close();
+  ok = ok && !out.fail();
+  std::remove(ok ? path.c_str() : out_path.c_str());
+}
+
+}  // namespace
+
+// Writes the live stream to rlog files on its own thread, fed by a bounded queue, so file IO,
+// capnp serialization of raw frames and segment rotation never stall the ingest thread.
 struct LiveStream::Logger {
-  Logger() : start_ts(seconds_since_epoch()), segment_num(-1) {}
+  // Queued data beyond this is dropped instead of growing without bound on a slow disk
+  static constexpr size_t kMaxPendingBytes = 64 * 1024 * 1024;
+  // The writer wakes up once this much is queued, or after kFlushInterval
+  static constexpr size_t kFlushBytes = 1024 * 1024;
+  static constexpr auto kFlushInterval = std::chrono::milliseconds(200);
+
+  Logger() : start_ts(seconds_since_epoch()), compression(settings.log_compression), thread(&Logger::run, this) {}
+  ~Logger() {
+    {
+      std::lock_guard lk(mutex);
+      exit = true;
+    }
+    cv.notify_one();
+    thread.join();
+    finishSegment();
+    for (auto& job : compress_jobs) {
+      job.waitForFinished();
+    }
+  }
 
+  // Called in streamThread
   void write(kj::ArrayPtr<capnp::word> data) {
+    const size_t bytes = data.size() * sizeof(capnp::word);
+    auto copy = kj::heapArray<capnp::word>(data);
+    enqueue(bytes, 1, [&]() { messages.push_back(std::move(copy)); });
+  }
+
+  void write(std::vector<Frame>&& frames) {
+    enqueue(frames.size() * sizeof(Frame), frames.size(), [&]() { frame_batches.push_back(std::move(frames)); });
+  }
+
+  std::atomic<uint64_t> dropped = 0;  // Messages (or raw frames) not logged because the queue was full
+
+ private:
+  template <typename Fn>
+  void enqueue(size_t bytes, size_t count, Fn&& push) {
+    bool wake = false;
+    {
+      std::lock_guard lk(mutex);
+      if (pending_bytes + bytes > kMaxPendingBytes) {
+        dropped.fetch_add(count, std::memory_order_relaxed);
+        return;
+      }
+      push();
+      wake = pending_bytes < kFlushBytes && pending_bytes + bytes >= kFlushBytes;
+      pending_bytes += bytes;
+    }
+    if (wake) cv.notify_one();
+  }
+
+  void run() {
+    std::unique_lock lk(mutex);
+    while (true) {
+      cv.wait_for(lk, kFlushInterval, [this]() { return exit || pending_bytes >= kFlushBytes; });
+      auto pending_messages = std::exchange(messages, {});
+      auto pending_batches = std::exchange(frame_batches, {});
+      pending_bytes = 0;
+      const bool done = exit;
+      lk.unlock();
+
+      buffer.clear();
+      for (const auto& m : pending_messages) {
+        auto bytes = m.asBytes();
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+      }
+      for (const auto& frames : pending_batches) {
+        serialize(frames);
+      }
+      flush();
+
+      if (done) break;
+      lk.lock();
+    }
+  }
+
+  // Frames read together share a timestamp and are logged as one can event
+  void serialize(const std::vector<Frame>& frames) {
+    for (size_t i = 0; i < frames.size();) {
+      size_t j = i;
+      while (j < frames.size() && frames[j].mono_ns == frames[i].mono_ns) ++j;
+
+      MessageBuilder msg;
+      auto evt = msg.initEvent();
+      evt.setLogMonoTime(frames[i].mono_ns);
+      auto can_data = evt.initCan(j - i);
+      for (size_t k = i; k < j; ++k) {
+        can_data[k - i].setAddress(frames[k].address);
+        can_data[k - i].setSrc(frames[k].src);
+        can_data[k - i].setDat(kj::arrayPtr(frames[k].dat.data(), frames[k].size));
+      }
+      auto bytes = capnp::messageToFlatArray(msg).asBytes();
+      buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+      i = j;
+    }
+  }
+
+  void flush() {
+    if (buffer.empty()) return;
+
     int n = (seconds_since_epoch() - start_ts) / 60.0;
     if (std::exchange(segment_num, n) != segment_num) {
+      finishSegment();
       QString dir = QString("%1/%2--%3")
                         .arg(settings.log_path)
                         .arg(QDateTime::fromSecsSinceEpoch(start_ts).toString("yyyy-MM-dd--hh-mm-ss"))
                         .arg(n);
       util::create_directories(dir.toStdString(), 0755);
-      fs.reset(new std::ofstream((dir + "/rlog").toStdString(), std::ios::binary | std::ios::out));
+      segment_path = (dir + "/rlog").toStdString();
+      fs.reset(new std::ofstream(segment_path, std::ios::binary | std::ios::out));
     }
+    fs->write(buffer.data(), buffer.size());
+  }
 
-    auto bytes = data.asBytes();
-    fs->write((const char*)bytes.begin(), bytes.size());
+  void finishSegment() {
+    if (!fs) return;
+    fs.reset();
+    if (compression != Settings::LogUncompressed) {
+      compress_jobs.push_back(QtConcurrent::run(compressSegment, segment_path, compression));
+    }
   }
 
-  std::unique_ptr<std::ofstream> fs;
-  int segment_num;
   uint64_t start_ts;
+  int segment_num = -1;
+  const Settings::LogCompression compression;
+  std::unique_ptr<std::ofstream> fs;
+  std::string segment_path;
+  std::vector<char> buffer;
+  std::vector<QFuture<void>> compress_jobs;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<kj::Array<capnp::word>> messages;
+  std::vector<std::vector<Frame>> frame_batches;
+  size_t pending_bytes = 0;
+  bool exit = false;
+  std::thread thread;
 };
 
+void LiveStream::Frame::assign(uint8_t src_, uint32_t address_, uint64_t mono_ns_, std::span<const uint8_t> data) {
+  mono_ns = mono_ns_;
+  address = address_;
+  src = src_;
+  size = std::min(data.size(), dat.size());
+  std::copy_n(data.begin(), size, dat.begin());
+}
+
 LiveStream::LiveStream(QObject* parent) : AbstractStream(parent) {
   if (settings.log_livestream) {
     logger = std::make_unique<Logger>();
@@ -46,6 +246,10 @@ LiveStream::LiveStream(QObject* parent) : AbstractStream(parent) {
 
 LiveStream::~LiveStream() { stop(); }
 
+uint64_t LiveStream::droppedLogMessages() const {
+  return logger ? logger->dropped.load(std::memory_order_relaxed) : 0;
+}
+
 void LiveStream::startUpdateTimer() {
   update_timer.stop();
   update_timer.start(1000.0 / settings.fps, this);
@@ -78,28 +282,54 @@ void LiveStream::handleEvent(kj::ArrayPtr<capnp::word> data) {
   auto event = reader.getRoot<cereal::Event>();
   if (event.which() == cereal::Event::Which::CAN) {
     const uint64_t mono_ns = event.getLogMonoTime();
-    std::lock_guard lk(lock);
     for (const auto& c : event.getCan()) {
-      received_events_.push_back(newEvent(mono_ns, c));
+      const auto dat = c.getDat();
+      enqueueFrame(c.getSrc(), c.getAddress(), mono_ns, {dat.begin(), dat.size()});
     }
   }
 }
 
+// called in streamThread
+void LiveStream::handleFrame(uint8_t src, uint32_t address, uint64_t mono_ns, std::span<const uint8_t> dat) {
+  enqueueFrame(src, address, mono_ns, dat);
+  if (logger) {
+    log_batch_.emplace_back().assign(src, address, mono_ns, dat);
+  }
+}
+
+// called in streamThread
+void LiveStream::commitFrames() {
+  if (logger && !log_batch_.empty()) {
+    logger->write(std::move(log_batch_));
+    log_batch_ = {};
+  }
+}
+
+void LiveStream::enqueueFrame(uint8_t src, uint32_t address, uint64_t mono_ns, std::span<const uint8_t> dat) {
+  if (!queue_.tryPushWith([&](Frame& f) { f.assign(src, address, mono_ns, dat); })) {
+    dropped_frames_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void LiveStream::drainQueue() {
+  MessageEventsMap new_events;
+  queue_.drain([&new_events](const Frame& f) {
+    const MessageId id(f.src, f.address);
+    new_events.try_emplace(id, id).first->second.append(f.mono_ns, f.dat.data(), f.size);
+  });
+
+  if (!new_events.empty()) {
+    mergeEvents(std::move(new_events));
+    lastest_event_ts = std::max(lastest_event_ts, last_event_ts_);
+  }
+}
+
 void LiveStream::timerEvent(QTimerEvent* event) {
   if (event->timerId() == timer_id) {
-    std::vector<const CanEvent*> local_queue;
-    {
-      std::lock_guard lk(lock);
-      local_queue.swap(received_events_);
-    }
-
-    if (!local_queue.empty()) {
-      mergeEvents(local_queue);
-      lastest_event_ts = std::max(lastest_event_ts, local_queue.back()->mono_ns);
-    }
+    drainQueue();
 
-    if (!all_events_.empty()) {
-      begin_event_ts = all_events_.front()->mono_ns;
+    if (first_event_ts_ != 0) {
+      begin_event_ts = first_event_ts_;
       processNewMessages();
       return;
     }
@@ -112,7 +342,7 @@ void LiveStream::processNewMessages() {
 
   if (first_update_ts == 0) {
     first_update_ts = nanos_since_boot();
-    first_event_ts = current_event_ts = all_events_.back()->mono_ns;
+    first_event_ts = current_event_ts = last_event_ts_;
   }
 
   if (paused_ || prev_speed != speed_) {
@@ -123,16 +353,10 @@ void LiveStream::processNewMessages() {
   }
 
   uint64_t last_ts = post_last_event && speed_ == 1.0
-                         ? all_events_.back()->mono_ns
+                         ? last_event_ts_
                          : first_event_ts + (nanos_since_boot() - first_update_ts) * speed_;
-  auto first = std::ranges::upper_bound(all_events_, current_event_ts, {}, &CanEvent::mono_ns);
-  auto last = std::ranges::upper_bound(first, all_events_.end(), last_ts, {}, &CanEvent::mono_ns);
-
-  for (auto it = first; it != last; ++it) {
-    const CanEvent* e = *it;
-    MessageId id(e->src, e->address);
-    processNewMessage(id, e->mono_ns, e->dat, e->size);
-    current_event_ts = e->mono_ns;
+  if (last_ts > current_event_ts) {
+    current_event_ts = std::max(current_event_ts, processNewEvents(current_event_ts + 1, last_ts));
   }
 
   commitSnapshots();
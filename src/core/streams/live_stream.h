@@ -2,10 +2,14 @@
 
 #include <QBasicTimer>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "abstract_stream.h"
+#include "utils/spsc_queue.h"
 
 class LiveStream : public AbstractStream {
   Q_OBJECT
@@ -23,19 +27,40 @@ class LiveStream : public AbstractStream {
   bool isPaused() const override { return paused_; }
   void pause(bool pause) override;
   void seekTo(double sec) override;
+  uint64_t droppedFrames() const override { return dropped_frames_.load(std::memory_order_relaxed); }
+  uint64_t droppedLogMessages() const override;
 
  protected:
   virtual void streamThread() = 0;
   void handleEvent(kj::ArrayPtr<capnp::word> event);
+  // Raw frame ingestion for sources that don't produce capnp messages. Frames are copied
+  // straight into the GUI queue; call commitFrames() once after each read from the device.
+  void handleFrame(uint8_t src, uint32_t address, uint64_t mono_ns, std::span<const uint8_t> dat);
+  void commitFrames();
 
  private:
   void startUpdateTimer();
   void timerEvent(QTimerEvent* event) override;
   void processNewMessages();
+  void drainQueue();
+  void enqueueFrame(uint8_t src, uint32_t address, uint64_t mono_ns, std::span<const uint8_t> dat);
+
+  // A CAN frame handed from the stream thread to the GUI thread
+  struct Frame {
+    uint64_t mono_ns;
+    uint32_t address;
+    uint8_t src;
+    uint8_t size;
+    std::array<uint8_t, 64> dat;
+    void assign(uint8_t src_, uint32_t address_, uint64_t mono_ns_, std::span<const uint8_t> data);
+  };
+  // ~5MB, several seconds of headroom on a saturated multi-bus CAN-FD setup
+  static constexpr size_t kQueueCapacity = 64 * 1024;
 
-  std::mutex lock;
   QThread* stream_thread;
-  std::vector<const CanEvent*> received_events_;
+  SpscQueue<Frame> queue_{kQueueCapacity};
+  std::atomic<uint64_t> dropped_frames_ = 0;
+  std::vector<Frame> log_batch_;  // Frames read since the last commitFrames(), only kept when logging
 
   int timer_id;
   QBasicTimer update_timer;
@@ -0,0 +1,229 @@
+#include "message_events.h"
+
+#include <cstring>
+
+template <>
+uint64_t TimeIndex<uint64_t>::get_timestamp(const uint64_t& ts) {
+  return ts;
+}
+
+// MessageEvents::Chunk
+
+size_t MessageEvents::Chunk::lowerBound(uint64_t ts) const {
+  if (empty()) return 0;
+  auto [lo, hi] = time_index_.getBounds(mono_ns_.front(), ts, size());
+  return std::lower_bound(mono_ns_.begin() + lo, mono_ns_.begin() + hi, ts) - mono_ns_.begin();
+}
+
+size_t MessageEvents::Chunk::upperBound(uint64_t ts) const {
+  if (empty()) return 0;
+  auto [lo, hi] = time_index_.getBounds(mono_ns_.front(), ts, size());
+  return std::upper_bound(mono_ns_.begin() + lo, mono_ns_.begin() + hi, ts) - mono_ns_.begin();
+}
+
+void MessageEvents::Chunk::append(uint64_t mono_ns, const uint8_t* dat, uint8_t size) {
+  if (empty()) {
+    stride_ = size;
+  } else if (size > stride_) {
+    restride(size);
+  } else if (size < stride_ && sizes_.empty()) {
+    sizes_.assign(this->size(), stride_);
+  }
+
+  mono_ns_.push_back(mono_ns);
+  const size_t offset = data_.size();
+  data_.resize(offset + stride_);
+  if (size > 0) std::memcpy(data_.data() + offset, dat, size);
+  if (!sizes_.empty()) sizes_.push_back(size);
+}
+
+void MessageEvents::Chunk::insert(size_t pos, const Chunk& other) {
+  if (other.empty()) return;
+
+  if (empty()) {
+    stride_ = other.stride_;
+  } else if (other.stride_ > stride_) {
+    restride(other.stride_);
+  }
+
+  const bool uniform = sizes_.empty() && other.sizes_.empty() && other.stride_ == stride_;
+  if (!uniform && sizes_.empty()) sizes_.assign(size(), stride_);
+
+  mono_ns_.insert(mono_ns_.begin() + pos, other.mono_ns_.begin(), other.mono_ns_.end());
+
+  auto data_pos = data_.begin() + pos * stride_;
+  if (other.stride_ == stride_) {
+    data_.insert(data_pos, other.data_.begin(), other.data_.end());
+  } else {
+    std::vector<uint8_t> padded(other.size() * stride_, 0);
+    for (size_t i = 0; i < other.size(); ++i) {
+      if (other.dataSize(i) > 0) std::memcpy(padded.data() + i * stride_, other.data(i), other.dataSize(i));
+    }
+    data_.insert(data_pos, padded.begin(), padded.end());
+  }
+
+  if (!sizes_.empty()) {
+    auto sizes_pos = sizes_.begin() + pos;
+    if (other.sizes_.empty()) {
+      sizes_.insert(sizes_pos, other.size(), other.stride_);
+    } else {
+      sizes_.insert(sizes_pos, other.sizes_.begin(), other.sizes_.end());
+    }
+  }
+}
+
+MessageEvents::Chunk MessageEvents::Chunk::split(size_t pos) {
+  Chunk tail;
+  tail.stride_ = stride_;
+  tail.mono_ns_.assign(mono_ns_.begin() + pos, mono_ns_.end());
+  tail.data_.assign(data_.begin() + pos * stride_, data_.end());
+  mono_ns_.resize(pos);
+  data_.resize(pos * stride_);
+  if (!sizes_.empty()) {
+    tail.sizes_.assign(sizes_.begin() + pos, sizes_.end());
+    sizes_.resize(pos);
+  }
+  syncIndex(true);
+  tail.syncIndex(true);
+  return tail;
+}
+
+void MessageEvents::Chunk::restride(uint8_t new_stride) {
+  if (empty()) {
+    stride_ = new_stride;
+    return;
+  }
+
+  if (sizes_.empty()) sizes_.assign(size(), stride_);
+
+  std::vector<uint8_t> new_data(size() * new_stride, 0);
+  for (size_t i = 0; i < size() && stride_ > 0; ++i) {
+    std::memcpy(new_data.data() + i * new_stride, data_.data() + i * stride_, stride_);
+  }
+  data_ = std::move(new_data);
+  stride_ = new_stride;
+}
+
+void MessageEvents::Chunk::syncIndex(bool rebuild) {
+  if (rebuild) time_index_.clear();
+  if (!empty()) time_index_.sync(mono_ns_, mono_ns_.front(), mono_ns_.back(), rebuild);
+}
+
+// MessageEvents
+
+std::pair<size_t, size_t> MessageEvents::locate(size_t i) const {
+  if (i >= size_) return {chunks_.size() - 1, chunks_.back().size()};
+  const size_t c = std::upper_bound(offsets_.begin(), offsets_.end(), i) - offsets_.begin() - 1;
+  return {c, i - offsets_[c]};
+}
+
+size_t MessageEvents::lowerBound(uint64_t ts) const {
+  auto it = std::partition_point(chunks_.begin(), chunks_.end(),
+                                 [ts](const Chunk& c) { return c.monoNs(c.size() - 1) < ts; });
+  if (it == chunks_.end()) return size_;
+  const size_t c = it - chunks_.begin();
+  return offsets_[c] + it->lowerBound(ts);
+}
+
+size_t MessageEvents::upperBound(uint64_t ts) const {
+  auto it = std::partition_point(chunks_.begin(), chunks_.end(),
+                                 [ts](const Chunk& c) { return c.monoNs(c.size() - 1) <= ts; });
+  if (it == chunks_.end()) return size_;
+  const size_t c = it - chunks_.begin();
+  return offsets_[c] + it->upperBound(ts);
+}
+
+std::pair<size_t, size_t> MessageEvents::indexRange(uint64_t t0, uint64_t t1) const {
+  const size_t first = lowerBound(t0);
+  return {first, std::max(first, upperBound(t1))};
+}
+
+void MessageEvents::append(uint64_t mono_ns, const uint8_t* dat, uint8_t size) {
+  if (chunks_.empty()) {
+    chunks_.emplace_back();
+    offsets_.push_back(0);
+  }
+  chunks_.back().append(mono_ns, dat, size);
+  ++size_;
+}
+
+size_t MessageEvents::merge(const MessageEvents& other) {
+  MessageEvents copy = other;
+  return merge(std::move(copy));
+}
+
+size_t MessageEvents::merge(MessageEvents&& other) {
+  if (other.empty()) return size_;
+
+  const size_t pos = mergeChunk(std::move(other.chunks_.front()));
+  for (size_t i = 1; i < other.chunks_.size(); ++i) {
+    mergeChunk(std::move(other.chunks_[i]));
+  }
+  other.clear();
+  return pos;
+}
+
+size_t MessageEvents::mergeChunk(Chunk&& chunk) {
+  if (chunk.empty()) return size_;
+
+  const size_t pos = upperBound(chunk.monoNs(0));
+  const size_t count = chunk.size();
+  const bool own_chunk = count >= kMinChunkSize;
+
+  // Adopted chunks keep their own index (if the batch builder already synced it), so only
+  // incremental syncs are needed for them.
+  if (chunks_.empty()) {
+    chunks_.push_back(std::move(chunk));
+    chunks_.back().syncIndex(false);
+  } else if (pos == size_) {
+    // Append: small batches extend the last chunk, large ones start a new chunk
+    auto& last = chunks_.back();
+    if (own_chunk || last.size() >= kMaxChunkSize) {
+      chunks_.push_back(std::move(chunk));
+      chunks_.back().syncIndex(false);
+    } else {
+      last.insert(last.size(), chunk);
+      last.syncIndex(false);
+    }
+  } else {
+    auto [c, off] = locate(pos);
+    if (!own_chunk) {
+      // Small out-of-order batch: splice into the containing chunk
+      chunks_[c].insert(off, chunk);
+      chunks_[c].syncIndex(true);
+    } else {
+      // Large batch: split the containing chunk if needed and insert the batch as its own chunk
+      if (off > 0) {
+        chunks_.insert(chunks_.begin() + c + 1, chunks_[c].split(off));
+        ++c;
+      }
+      chunks_.insert(chunks_.begin() + c, std::move(chunk));
+      chunks_[c].syncIndex(false);
+    }
+  }
+
+  size_ += count;
+  updateOffsets();
+  return pos;
+}
+
+void MessageEvents::syncIndex() {
+  for (auto& c : chunks_) {
+    c.syncIndex(false);
+  }
+}
+
+void MessageEvents::updateOffsets() {
+  offsets_.resize(chunks_.size());
+  size_t offset = 0;
+  for (size_t i = 0; i < chunks_.size(); ++i) {
+    offsets_[i] = offset;
+    offset += chunks_[i].size();
+  }
+}
+
+void MessageEvents::clear() {
+  chunks_.clear();
+  offsets_.clear();
+  size_ = 0;
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/dbc/dbc_message.h"
+#include "utils/time_index.h"
+
+// Lightweight view of a single CAN frame. `dat` points into the owning MessageEvents.
+struct CanEvent {
+  uint8_t src;
+  uint32_t address;
+  uint64_t mono_ns;
+  uint8_t size;
+  const uint8_t* dat;
+};
+
+/**
+ * @brief Columnar, per-message event store.
+ * Events are kept in time-ordered, non-overlapping runs (chunks). Each chunk stores
+ * its timestamps and payloads in two contiguous arrays, with payloads at a fixed
+ * stride, so scans touch memory sequentially. Segment-sized batches become chunks
+ * of their own, which makes inserting a segment in the middle of a route O(segment)
+ * and only (re)builds the time index of the affected chunk.
+ */
+class MessageEvents {
+ public:
+  class Chunk {
+   public:
+    inline size_t size() const { return mono_ns_.size(); }
+    inline bool empty() const { return mono_ns_.empty(); }
+    inline uint8_t stride() const { return stride_; }
+    inline uint64_t monoNs(size_t i) const { return mono_ns_[i]; }
+    inline const uint8_t* data(size_t i) const { return data_.data() + i * stride_; }
+    inline uint8_t dataSize(size_t i) const { return sizes_.empty() ? stride_ : sizes_[i]; }
+    inline const uint8_t* sizes() const { return sizes_.empty() ? nullptr : sizes_.data(); }  // Null when all are stride
+    inline const std::vector<uint64_t>& timestamps() const { return mono_ns_; }
+    size_t lowerBound(uint64_t ts) const;
+    size_t upperBound(uint64_t ts) const;
+
+   private:
+    friend class MessageEvents;
+    friend class EventCache;
+    void append(uint64_t mono_ns, const uint8_t* dat, uint8_t size);
+    void insert(size_t pos, const Chunk& other);
+    Chunk split(size_t pos);
+    void restride(uint8_t new_stride);
+    void syncIndex(bool rebuild);
+
+    uint8_t stride_ = 0;
+    std::vector<uint64_t> mono_ns_;
+    std::vector<uint8_t> data_;
+    std::vector<uint8_t> sizes_;  // Only populated once frame sizes differ within the chunk
+    TimeIndex<uint64_t> time_index_;
+  };
+
+  // Random-access iterator over all chunks. Invalidated by merge().
+  class Iterator {
+   public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = CanEvent;
+    using difference_type = std::ptrdiff_t;
+    using reference = CanEvent;
+
+    struct ArrowProxy {
+      CanEvent e;
+      const CanEvent* operator->() const { return &e; }
+    };
+
+    Iterator() = default;
+    Iterator(const MessageEvents* events, size_t i) : events_(events) { seek(i); }
+
+    inline CanEvent operator*() const { return events_->makeEvent(events_->chunks_[chunk_], offset_); }
+    inline ArrowProxy operator->() const { return {**this}; }
+    inline CanEvent operator[](difference_type n) const { return *(*this + n); }
+    inline uint64_t monoNs() const { return events_->chunks_[chunk_].monoNs(offset_); }
+    inline size_t index() const { return i_; }
+
+    Iterator& operator++() {
+      ++i_;
+      if (++offset_ == events_->chunks_[chunk_].size() && chunk_ + 1 < events_->chunks_.size()) {
+        ++chunk_;
+        offset_ = 0;
+      }
+      return *this;
+    }
+    Iterator& operator--() {
+      --i_;
+      if (offset_ == 0) offset_ = events_->chunks_[--chunk_].size();
+      --offset_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      auto t = *this;
+      ++*this;
+      return t;
+    }
+    Iterator operator--(int) {
+      auto t = *this;
+      --*this;
+      return t;
+    }
+    Iterator& operator+=(difference_type n) {
+      seek(i_ + n);
+      return *this;
+    }
+    Iterator& operator-=(difference_type n) { return *this += -n; }
+
+    friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+    friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+    friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const Iterator& a, const Iterator& b) {
+      return static_cast<difference_type>(a.i_) - static_cast<difference_type>(b.i_);
+    }
+    friend bool operator==(const Iterator& a, const Iterator& b) { return a.i_ == b.i_; }
+    friend auto operator<=>(const Iterator& a, const Iterator& b) { return a.i_ <=> b.i_; }
+
+   private:
+    void seek(size_t i) {
+      i_ = i;
+      if (!events_ || events_->chunks_.empty()) return;
+      std::tie(chunk_, offset_) = events_->locate(i);
+    }
+
+    const MessageEvents* events_ = nullptr;
+    size_t i_ = 0;
+    size_t chunk_ = 0;
+    size_t offset_ = 0;
+  };
+  using const_iterator = Iterator;
+
+  MessageEvents() = default;
+  explicit MessageEvents(const MessageId& id) : id_(id) {}
+
+  inline const MessageId& id() const { return id_; }
+  inline size_t size() const { return size_; }
+  inline bool empty() const { return size_ == 0; }
+  inline const std::vector<Chunk>& chunks() const { return chunks_; }
+
+  inline uint64_t monoNs(size_t i) const {
+    auto [c, off] = locate(i);
+    return chunks_[c].monoNs(off);
+  }
+  inline CanEvent operator[](size_t i) const {
+    auto [c, off] = locate(i);
+    return makeEvent(chunks_[c], off);
+  }
+  inline CanEvent front() const { return makeEvent(chunks_.front(), 0); }
+  inline CanEvent back() const { return makeEvent(chunks_.back(), chunks_.back().size() - 1); }
+  inline Iterator begin() const { return {this, 0}; }
+  inline Iterator end() const { return {this, size_}; }
+
+  // Index of the first event with mono_ns >= ts (resp. > ts), narrowed by the chunk time indexes.
+  size_t lowerBound(uint64_t ts) const;
+  size_t upperBound(uint64_t ts) const;
+  // Index range of events within [t0, t1]
+  std::pair<size_t, size_t> indexRange(uint64_t t0, uint64_t t1) const;
+
+  // Appends a frame without touching the time index. Used to build batches before merge().
+  void append(uint64_t mono_ns, const uint8_t* dat, uint8_t size);
+  // Merges a time-ordered batch that does not interleave with existing events.
+  // Returns the index at which the batch was inserted.
+  size_t merge(const MessageEvents& other);
+  // Same as above, but adopts the batch's chunks without copying where possible.
+  size_t merge(MessageEvents&& other);
+  // Brings the time index of every chunk up to date. Lets batch builders index off the GUI thread.
+  void syncIndex();
+  void clear();
+
+ private:
+  friend class EventCache;
+
+  // Batches at least this large are kept as a chunk of their own
+  static constexpr size_t kMinChunkSize = 1024;
+  // Small appends are copied into the last chunk until it reaches this size
+  static constexpr size_t kMaxChunkSize = 64 * 1024;
+
+  inline CanEvent makeEvent(const Chunk& c, size_t i) const {
+    return {id_.source, id_.address, c.monoNs(i), c.dataSize(i), c.data(i)};
+  }
+  // Maps a global index to (chunk, offset). The end index maps past the last chunk's end.
+  std::pair<size_t, size_t> locate(size_t i) const;
+  size_t mergeChunk(Chunk&& chunk);
+  void updateOffsets();
+
+  MessageId id_;
+  size_t size_ = 0;
+  std::vector<Chunk> chunks_;
+  std::vector<size_t> offsets_;  // Global index of the first event of each chunk
+};
+
+using CanEventIter = MessageEvents::const_iterator;
+using CanEventRange = std::ranges::subrange<CanEventIter>;
+using MessageEventsMap = std::unordered_map<MessageId, MessageEvents>;
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <utility>
 
 #include "modules/settings/settings.h"
 #include "utils/util.h"
@@ -50,21 +51,23 @@ void MessageState::init(const uint8_t* new_data, uint8_t data_size, double curre
   freq = 0;
   last_freq_ts = current_ts;
 
-  // Wipe arrays for the new message length
-  std::memset(data.data(), 0, MAX_CAN_LEN);
-  std::memcpy(data.data(), new_data, size);
-
-  last_change_ts.fill(current_ts);
-  last_delta.fill(0);
-  trend_weight.fill(0);
-  colors.fill(0);
-  detected_patterns.fill(DataPattern::None);
-
-  for (auto& f : bit_flips) f.fill(0);
-  for (auto& h : bit_high_counts) h.fill(0);
+  // The per-byte storage only grows, so ignore masks and suppression of bytes past a shorter
+  // length survive until the length comes back. They are owned by applyMask() and the mute functions.
+  const int old_blocks = allocatedBlocks();
+  const int num_blocks = numBlocks();
+  if (num_blocks > old_blocks) {
+    std::vector<uint64_t> words(num_blocks * 2, 0);
+    std::copy_n(words_.begin() + old_blocks, old_blocks, words.begin() + num_blocks);
+    words_ = std::move(words);
+  }
+  std::fill_n(words_.begin(), allocatedBlocks(), 0);
+  std::memcpy(words_.data(), new_data, size);
 
-  last_data_64.fill(0);
-  std::memcpy(last_data_64.data(), new_data, size);
+  if (bytes_.size() < size) bytes_.resize(size);
+  for (auto& b : bytes_) {
+    b = {.last_change_ts = current_ts, .suppressed = b.suppressed};
+  }
+  bit_stats_.clear();
 }
 
 void MessageState::update(const uint8_t* new_data, uint8_t data_size, double current_ts, double manual_freq, bool is_seek) {
@@ -77,7 +80,9 @@ void MessageState::update(const uint8_t* new_data, uint8_t data_size, double cur
   count++;
   updateFrequency(current_ts, manual_freq, is_seek);
 
-  const int num_blocks = (size + 7) / 8;
+  const int num_blocks = numBlocks();
+  uint64_t* last_data_64 = words_.data();
+  const uint64_t* ignore_bit_mask = last_data_64 + allocatedBlocks();
   for (int b = 0; b < num_blocks; ++b) {
     const int offset = b * 8;
     const int block_len = std::min(8, size - offset);
@@ -87,24 +92,24 @@ void MessageState::update(const uint8_t* new_data, uint8_t data_size, double cur
 
     uint64_t raw_diff_64 = (cur_64 ^ last_data_64[b]);
     if (raw_diff_64 != 0) {
-      uint64_t analysis_diff_64 = raw_diff_64 & ~ignore_bit_mask[b];
-      while (analysis_diff_64 != 0) {
-        // Find first byte with an unmasked change
-        int first_bit = __builtin_ctzll(analysis_diff_64);
-        int byte_in_block = first_bit / 8;
-        int global_idx = offset + byte_in_block;
-
-        // Extract byte-level values for specific mutation analysis
-        uint8_t byte_diff = static_cast<uint8_t>((analysis_diff_64 >> (byte_in_block * 8)) & 0xFF);
-        uint8_t old_byte = static_cast<uint8_t>((last_data_64[b] >> (byte_in_block * 8)) & 0xFF);
-        uint8_t new_byte = new_data[global_idx];
-
-        analyzeByteMutation(global_idx, old_byte, new_byte, byte_diff, current_ts);
-
-        // Clear the entire byte from the analysis mask to find the next changed byte
-        analysis_diff_64 &= ~(0xFFULL << (byte_in_block * 8));
+      const uint64_t analysis_diff_64 = raw_diff_64 & ~ignore_bit_mask[b];
+      if (analysis_diff_64 != 0) {
+        if (bit_stats_.empty()) bit_stats_.resize(num_blocks);
+
+        // A pending entropy decision must see the bit stats as of its own mutation
+        const uint64_t changed = bit_stats::changedLanes(analysis_diff_64);
+        for (uint64_t lanes = changed; lanes != 0; lanes &= lanes - 1) {
+          resolvePattern(offset + __builtin_ctzll(lanes) / 8);
+        }
+        bit_stats::accumulate(bit_stats_[b], cur_64, analysis_diff_64);
+
+        for (uint64_t lanes = changed; lanes != 0; lanes &= lanes - 1) {
+          const int byte_in_block = __builtin_ctzll(lanes) / 8;
+          const uint8_t old_byte = static_cast<uint8_t>(last_data_64[b] >> (byte_in_block * 8));
+          const uint8_t new_byte = static_cast<uint8_t>(cur_64 >> (byte_in_block * 8));
+          analyzeByteMutation(offset + byte_in_block, old_byte, new_byte, current_ts);
+        }
       }
-      std::memcpy(data.data() + offset, new_data + offset, block_len);
       last_data_64[b] = cur_64;
     }
   }
@@ -131,30 +136,18 @@ void MessageState::updateFrequency(double current_ts, double manual_freq, bool i
   }
 }
 
-void MessageState::analyzeByteMutation(int i, uint8_t old_v, uint8_t new_v, uint8_t diff, double current_ts) {
+// Bit stats are accumulated by the caller
+void MessageState::analyzeByteMutation(int i, uint8_t old_v, uint8_t new_v, double current_ts) {
   const int delta = static_cast<int>(new_v) - static_cast<int>(old_v);
 
-  // 1. Bit Stats
-  uint8_t mask = 0x80;  // 1000 0000
-  for (int bit = 0; bit < 8; ++bit) {
-    if (new_v & mask) bit_high_counts[i][bit]++;
-    if (diff & mask) bit_flips[i][bit]++;
-    mask >>= 1;
-  }
-
-  // 2. Entropy
-  float total_entropy = 0.0f;
-  for (int bit = 0; bit < 8; ++bit) {
-    total_entropy += getEntropy(bit_high_counts[i][bit], count);
-  }
-  const float avg_entropy = total_entropy / 8.0;
+  ByteState& state = bytes_[i];
 
-  // 3. Trends (Using SoA arrays last_delta[i] and trend_weight[i])
-  const bool is_toggle = (delta == -last_delta[i]) && (delta != 0);
-  const bool is_constant_step = (delta == last_delta[i]) && (delta != 0);
-  const bool same_direction = (delta > 0) == (last_delta[i] > 0);
+  // 1. Trends
+  const bool is_toggle = (delta == -state.last_delta) && (delta != 0);
+  const bool is_constant_step = (delta == state.last_delta) && (delta != 0);
+  const bool same_direction = (delta > 0) == (state.last_delta > 0);
 
-  int& weight = trend_weight[i];
+  int& weight = state.trend_weight;
   if (is_constant_step) {
     weight = std::min(TREND_MAX, weight + (TREND_INC * 2));
   } else if (delta != 0 && same_direction) {
@@ -165,36 +158,61 @@ void MessageState::analyzeByteMutation(int i, uint8_t old_v, uint8_t new_v, uint
     weight = std::max(0, weight - JITTER_DECAY);
   }
 
-  // 4. Pattern logic
-  DataPattern new_p = DataPattern::None;
+  // 2. Pattern logic. When only the entropy can still mark the byte as noisy, the check is
+  // deferred: the high counts of a byte stay unchanged until its next mutation.
+  state.entropy_pending_count = 0;
   if (is_toggle && weight < LIMIT_TOGGLE) {
-    new_p = DataPattern::Toggle;
+    state.pattern = DataPattern::Toggle;
   } else if (weight > LIMIT_TREND) {
-    new_p = (delta > 0) ? DataPattern::Increasing : DataPattern::Decreasing;
-  } else if (avg_entropy > ENTROPY_THRESHOLD || weight > LIMIT_NOISY) {
-    new_p = DataPattern::RandomlyNoisy;
+    state.pattern = (delta > 0) ? DataPattern::Increasing : DataPattern::Decreasing;
+  } else if (weight > LIMIT_NOISY) {
+    state.pattern = DataPattern::RandomlyNoisy;
+  } else {
+    state.entropy_pending_count = count;
   }
 
-  if (new_p != DataPattern::None) {
-    detected_patterns[i] = new_p;
+  state.last_delta = delta;
+  state.last_change_ts = current_ts;
+}
+
+void MessageState::resolvePattern(int i) {
+  ByteState& state = bytes_[i];
+  const uint32_t total = std::exchange(state.entropy_pending_count, 0);
+  if (total == 0 || state.pattern == DataPattern::RandomlyNoisy) return;
+
+  float total_entropy = 0.0f;
+  for (int bit = 0; bit < 8; ++bit) {
+    total_entropy += getEntropy(bit_stats_[i / 8].highCount(i % 8, bit), total);
+  }
+  const float avg_entropy = total_entropy / 8.0;
+  if (avg_entropy > ENTROPY_THRESHOLD) {
+    state.pattern = DataPattern::RandomlyNoisy;
   }
+}
 
-  last_delta[i] = delta;
-  last_change_ts[i] = current_ts;
+void MessageState::resolvePatterns() {
+  for (size_t i = 0; i < size; ++i) resolvePattern(i);
+}
+
+size_t MessageState::memoryUsage() const {
+  return sizeof(*this) + words_.capacity() * sizeof(uint64_t) + bytes_.capacity() * sizeof(ByteState) +
+         bit_stats_.capacity() * sizeof(BitStats);
 }
 
 void MessageState::updateAllPatternColors(double current_can_sec) {
   for (size_t i = 0; i < size; ++i) {
-    colors[i] = colorFromDataPattern(detected_patterns[i], current_can_sec, last_change_ts[i], freq);
+    resolvePattern(i);
+    bytes_[i].color = colorFromDataPattern(bytes_[i].pattern, current_can_sec, bytes_[i].last_change_ts, freq);
   }
 }
 
 void MessageState::applyMask(const std::vector<uint8_t>& mask) {
-  ignore_bit_mask.fill(0);
+  uint64_t* ignore_bit_mask = words_.data() + allocatedBlocks();
+  std::fill_n(ignore_bit_mask, allocatedBlocks(), 0);
 
-  for (size_t i = 0; i < size; ++i) {
+  for (size_t i = 0; i < bytes_.size(); ++i) {
     uint8_t m = 0;
-    if (is_suppressed[i]) {
+    if (bytes_[i].suppressed) {
       m = 0xFF;
     } else if (i < mask.size()) {
       m = mask[i];
@@ -202,9 +220,9 @@ void MessageState::applyMask(const std::vector<uint8_t>& mask) {
 
     if (m != 0) {
       ignore_bit_mask[i / 8] |= (static_cast<uint64_t>(m) << ((i % 8) * 8));
-      if (m == 0xFF) {
-        bit_flips[i].fill(0);
-        bit_high_counts[i].fill(0);
+      if (m == 0xFF && i / 8 < bit_stats_.size()) {
+        resolvePattern(i);
+        bit_stats_[i / 8].clearByte(i % 8);
       }
     }
   }
@@ -214,11 +232,11 @@ size_t MessageState::muteActiveBits(const std::vector<uint8_t>& mask) {
   bool modified = false;
   size_t cnt = 0;
   for (size_t i = 0; i < size; ++i) {
-    if (!is_suppressed[i] && (ts - last_change_ts[i] < kMuteActivityWindowSec)) {
-      is_suppressed[i] = 1;  // Mark as suppressed
+    if (!bytes_[i].suppressed && (ts - bytes_[i].last_change_ts < kMuteActivityWindowSec)) {
+      bytes_[i].suppressed = 1;  // Mark as suppressed
       modified = true;
     }
-    cnt += is_suppressed[i];
+    cnt += bytes_[i].suppressed;
   }
   if (modified) {
     applyMask(mask);
@@ -227,7 +245,9 @@ size_t MessageState::muteActiveBits(const std::vector<uint8_t>& mask) {
 }
 
 void MessageState::unmuteActiveBits(const std::vector<uint8_t>& mask) {
-  is_suppressed.fill(0);
+  for (auto& b : bytes_) {
+    b.suppressed = 0;
+  }
   // Refresh the mask (this will re-allow highlights for these bits)
   applyMask(mask);
 }
@@ -286,9 +306,20 @@ void MessageSnapshot::updateFrom(const MessageState& s) {
   size = s.size;
   is_active = true;
 
-  std::memcpy(data.data(), s.data.data(), size);
-  std::memcpy(colors.data(), s.colors.data(), size * sizeof(uint32_t));
-  std::memcpy(bit_flips.data(), s.bit_flips.data(), size * sizeof(bit_flips[0]));
+  std::memcpy(data.data(), s.data(), size);
+  for (size_t i = 0; i < size; ++i) {
+    patterns[i] = s.bytes_[i].pattern;
+    last_change_ts[i] = s.bytes_[i].last_change_ts;
+    for (int bit = 0; bit < 8; ++bit) {
+      bit_flips[i][bit] = s.bit_stats_.empty() ? 0 : s.bit_stats_[i / 8].flipCount(i % 8, bit);
+    }
+  }
+}
+
+void MessageSnapshot::updateColors(double now) {
+  for (size_t i = 0; i < size; ++i) {
+    colors[i] = colorFromDataPattern(patterns[i], now, last_change_ts[i], freq);
+  }
 }
 
 void MessageSnapshot::updateActiveState(double now) {
@@ -4,6 +4,7 @@
 #include <array>
 #include <vector>
 
+#include "bit_stats.h"
 #include "core/dbc/dbc_message.h"
 
 constexpr int MAX_CAN_LEN = 64;
@@ -15,44 +16,62 @@ class MessageState {
   void init(const uint8_t* new_data, uint8_t data_size, double current_ts);
   void update(const uint8_t* new_data, uint8_t data_size, double current_ts, double manual_freq = 0, bool is_seek = false);
   void updateAllPatternColors(double current_ts);
+  // Settles deferred pattern decisions, so a snapshot can derive colors without the state
+  void resolvePatterns();
+  size_t memoryUsage() const;
   void applyMask(const std::vector<uint8_t>& mask);
   size_t muteActiveBits(const std::vector<uint8_t>& mask);
   void unmuteActiveBits(const std::vector<uint8_t>& mask);
 
+  inline const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(words_.data()); }
+  inline uint32_t color(size_t i) const { return bytes_[i].color; }
+
+  // Hot fields: together with last_freq_ts and the words_ header they fill the first cache line.
+  // The payload words are a separate allocation, so an unchanged frame touches two lines.
   double ts = 0.0;     // Latest message timestamp
   double freq = 0.0;   // Message frequency (Hz)
   uint32_t count = 0;  // Total messages received
   uint8_t size = 0;    // Message length in bytes
   bool dirty = false;  // Whether this message has uncommitted changes (for snapshotting)
 
-  std::array<uint8_t, MAX_CAN_LEN> data = {0};  // Raw payload
-  std::array<uint32_t, MAX_CAN_LEN> colors = {0};
+ private:
+  friend class MessageSnapshot;
 
-  // Stats (only accessed on change, so we keep them slightly separate)
-  std::array<std::array<uint32_t, 8>, MAX_CAN_LEN> bit_flips = {};
-  std::array<std::array<uint32_t, 8>, MAX_CAN_LEN> bit_high_counts = {};
+  // Per-byte analysis state, only touched when the byte changes
+  struct ByteState {
+    double last_change_ts = 0;
+    int32_t last_delta = 0;
+    int32_t trend_weight = 0;
+    // Message count at the last mutation whose pattern hinges on bit entropy (0 = none pending).
+    // Entropy is only evaluated when the pattern is needed, see resolvePattern().
+    uint32_t entropy_pending_count = 0;
+    uint32_t color = 0;
+    DataPattern pattern = DataPattern::None;
+    uint8_t suppressed = 0;
+  };
 
- private:
-  void analyzeByteMutation(int byte_index, uint8_t old_val, uint8_t new_val, uint8_t diff, double current_ts);
+  void analyzeByteMutation(int byte_index, uint8_t old_val, uint8_t new_val, double current_ts);
+  void resolvePattern(int byte_index);
   void updateFrequency(double current_ts, double manual_freq, bool is_seek);
+  inline int numBlocks() const { return (size + 7) / 8; }
+  inline int allocatedBlocks() const { return words_.size() / 2; }
 
   static constexpr double kMuteActivityWindowSec = 2.0;
 
   double last_freq_ts = 0;
-  std::array<double, MAX_CAN_LEN> last_change_ts = {0};
-  std::array<int32_t, MAX_CAN_LEN> last_delta = {0};
-  std::array<int32_t, MAX_CAN_LEN> trend_weight = {0};
-  std::array<uint8_t, MAX_CAN_LEN> is_suppressed = {0};  // Use uint8 for better packing than bool
-  std::array<DataPattern, MAX_CAN_LEN> detected_patterns = {DataPattern::None};
-  std::array<uint64_t, 8> last_data_64 = {0};
-  std::array<uint64_t, 8> ignore_bit_mask = {0};
+  // Payload as 8-byte blocks, followed by the ignore mask of each block. Sized for the longest payload seen.
+  std::vector<uint64_t> words_;
+  std::vector<ByteState> bytes_;     // One entry per byte of the longest payload seen
+  std::vector<BitStats> bit_stats_;  // One entry per payload block, allocated on the first change
 };
 
 class MessageSnapshot {
  public:
   MessageSnapshot() = default;
   explicit MessageSnapshot(const MessageState& s) { updateFrom(s); }
+  // Copies everything but the colors. Patterns must be resolved first.
   void updateFrom(const MessageState& s);
+  void updateColors(double now);
   void updateActiveState(double now);
 
   double ts = 0.0;
@@ -63,6 +82,8 @@ class MessageSnapshot {
   std::array<uint8_t, MAX_CAN_LEN> data = {0};
   std::array<uint32_t, MAX_CAN_LEN> colors = {0};
   std::array<std::array<uint32_t, 8>, MAX_CAN_LEN> bit_flips = {{}};
+  std::array<DataPattern, MAX_CAN_LEN> patterns = {};
+  std::array<double, MAX_CAN_LEN> last_change_ts = {0};
 };
 
 uint32_t colorFromDataPattern(DataPattern pattern, double current_ts, double last_ts, double freq);
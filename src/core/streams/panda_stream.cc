@@ -4,6 +4,8 @@
 #include <QThread>
 #include <QTimer>
 
+#include "common/timing.h"
+
 PandaStream::PandaStream(QObject* parent, PandaStreamConfig config_) : config(config_), LiveStream(parent) {
   if (!connect()) {
     throw std::runtime_error("Failed to connect to panda");
@@ -58,16 +60,11 @@ void PandaStream::streamThread() {
       continue;
     }
 
-    MessageBuilder msg;
-    auto evt = msg.initEvent();
-    auto canData = evt.initCan(raw_can_data.size());
-    for (uint i = 0; i < raw_can_data.size(); i++) {
-      canData[i].setAddress(raw_can_data[i].address);
-      canData[i].setDat(kj::arrayPtr((uint8_t*)raw_can_data[i].dat.data(), raw_can_data[i].dat.size()));
-      canData[i].setSrc(raw_can_data[i].src);
+    const uint64_t mono_ns = nanos_since_boot();
+    for (const auto& frame : raw_can_data) {
+      handleFrame(frame.src, frame.address, mono_ns, {(const uint8_t*)frame.dat.data(), frame.dat.size()});
     }
-
-    handleEvent(capnp::messageToFlatArray(msg));
+    commitFrames();
 
     panda->send_heartbeat(false);
   }
@@ -2,9 +2,11 @@
 
 #include <QMessageBox>
 #include <QTimer>
+#include <QtConcurrent>
 
 #include "common/timing.h"
 #include "common/util.h"
+#include "core/streams/event_cache.h"
 #include "modules/settings/settings.h"
 
 ReplayStream::ReplayStream(QObject* parent) : AbstractStream(parent) {
@@ -19,7 +21,15 @@ ReplayStream::ReplayStream(QObject* parent) : AbstractStream(parent) {
   ui_update_timer = new QTimer(this);
   ui_update_timer->setInterval(1000 / settings.fps);
 
-  connect(&settings, &Settings::changed, this, [this]() {
+  // The decode jobs run on the thread pool and must not read settings while the GUI changes them
+  auto copy_cache_options = [this]() {
+    cache_enabled_ = settings.cache_can_index;
+    cache_max_bytes_ = uint64_t(settings.can_index_cache_mb) * 1024 * 1024;
+  };
+  copy_cache_options();
+
+  connect(&settings, &Settings::changed, this, [this, copy_cache_options]() {
+    copy_cache_options();
     if (replay) replay->setSegmentCacheLimit(settings.max_cached_minutes);
     if (ui_update_timer) {
       ui_update_timer->setInterval(1000 / settings.fps);
@@ -30,26 +40,75 @@ ReplayStream::ReplayStream(QObject* parent) : AbstractStream(parent) {
   ui_update_timer->start();
 }
 
+// Called on the replay thread. Segments are decoded in parallel on the global thread pool,
+// each into its own event batch; the GUI thread only splices the finished batches into the store.
 void ReplayStream::mergeSegments() {
   auto event_data = replay->getEventData();
+  std::vector<std::pair<int, const LogReader*>> new_logs;
   for (const auto& [n, seg] : event_data->segments) {
-    if (!processed_segments.count(n)) {
-      processed_segments.insert(n);
-
-      std::vector<const CanEvent*> new_events;
-      new_events.reserve(seg->log->events.size());
-      for (const Event& e : seg->log->events) {
-        if (e.which == cereal::Event::Which::CAN) {
-          capnp::FlatArrayMessageReader reader(e.data);
-          auto event = reader.getRoot<cereal::Event>();
-          for (const auto& c : event.getCan()) {
-            new_events.push_back(newEvent(e.mono_time, c));
-          }
+    if (processed_segments.insert(n).second) {
+      new_logs.emplace_back(n, seg->log.get());
+    }
+  }
+  if (new_logs.empty()) return;
+
+  const QString route = routeName();
+  const CacheOptions cache = {cache_enabled_, cache_max_bytes_};
+  std::atomic<bool> saved = false;
+  auto batches = QtConcurrent::blockingMapped<std::vector<MessageEventsMap>>(
+      new_logs, [&route, &cache, &saved](const std::pair<int, const LogReader*>& seg) {
+        return decodeSegment(route, seg.first, seg.second, cache, saved);
+      });
+
+  QMetaObject::invokeMethod(
+      this,
+      [this, &batches]() {
+        for (auto& batch : batches) {
+          mergeEvents(std::move(batch));
         }
+      },
+      Qt::BlockingQueuedConnection);
+
+  // One pass over the cache directory per batch, never dropping this route's files
+  if (saved) EventCache::evict(cache.max_bytes, route);
+}
+
+MessageEventsMap ReplayStream::decodeSegment(const QString& route, int segment, const LogReader* log,
+                                             const CacheOptions& cache, std::atomic<bool>& saved) {
+  // The fingerprint only needs the already-parsed event headers, so it is cheap to compute
+  EventCache::Fingerprint fingerprint;
+  for (const Event& e : log->events) {
+    if (e.which == cereal::Event::Which::CAN) {
+      if (fingerprint.can_events++ == 0) fingerprint.first_mono_ns = e.mono_time;
+      fingerprint.last_mono_ns = e.mono_time;
+    }
+  }
+
+  if (cache.enabled) {
+    if (auto cached = EventCache::load(route, segment, fingerprint)) {
+      return std::move(*cached);
+    }
+  }
+
+  MessageEventsMap new_events;
+  new_events.reserve(1024);
+  for (const Event& e : log->events) {
+    if (e.which == cereal::Event::Which::CAN) {
+      capnp::FlatArrayMessageReader reader(e.data);
+      auto event = reader.getRoot<cereal::Event>();
+      for (const auto& c : event.getCan()) {
+        appendEvent(new_events, e.mono_time, c);
       }
-      mergeEvents(new_events);
     }
   }
+  for (auto& [_, events] : new_events) {
+    events.syncIndex();
+  }
+
+  if (cache.enabled && fingerprint.can_events > 0) {
+    if (EventCache::save(route, segment, fingerprint, new_events)) saved = true;
+  }
+  return new_events;
 }
 
 bool ReplayStream::loadRoute(const QString& route, const QString& data_dir, uint32_t replay_flags, bool auto_source) {
@@ -71,9 +130,7 @@ bool ReplayStream::loadRoute(const QString& route, const QString& data_dir, uint
     waitForSeekFinished();
   };
   replay->onQLogLoaded = [this](std::shared_ptr<LogReader> qlog) { emit qLogLoaded(qlog); };
-  replay->onSegmentsMerged = [this]() {
-    QMetaObject::invokeMethod(this, &ReplayStream::mergeSegments, Qt::BlockingQueuedConnection);
-  };
+  replay->onSegmentsMerged = [this]() { mergeSegments(); };
 
   bool success = replay->load();
   if (!success) {
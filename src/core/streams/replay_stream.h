@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <set>
 #include <vector>
@@ -37,9 +38,19 @@ class ReplayStream : public AbstractStream {
   void pause(bool pause) override;
 
  private:
+  // CAN index cache settings, copied from the GUI thread for the decode jobs
+  struct CacheOptions {
+    bool enabled;
+    uint64_t max_bytes;
+  };
+
   void mergeSegments();
+  static MessageEventsMap decodeSegment(const QString& route, int segment, const LogReader* log,
+                                        const CacheOptions& cache, std::atomic<bool>& saved);
   std::unique_ptr<Replay> replay = nullptr;
   std::set<int> processed_segments;
   std::unique_ptr<OpenpilotPrefix> op_prefix;
   QTimer* ui_update_timer = nullptr;
+  std::atomic<bool> cache_enabled_ = false;
+  std::atomic<uint64_t> cache_max_bytes_ = 0;
 };
@@ -2,9 +2,38 @@
 
 #include <QDebug>
 #include <QThread>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <net/if.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <ctime>
+#endif
+
+#include "common/timing.h"
 
 SocketCanStream::SocketCanStream(QObject* parent, SocketCanStreamConfig config_) : config(config_), LiveStream(parent) {
-  if (!available()) {
+  if (config.native) {
+    if (!nativeAvailable()) {
+      throw std::runtime_error("Native SocketCAN backend is only available on Linux");
+    }
+    qDebug() << "Opening raw SocketCAN interfaces" << config.device;
+    if (!connectNative()) {
+      closeNative();
+      throw std::runtime_error("Failed to open SocketCAN interface");
+    }
+    return;
+  }
+
+  if (!QCanBus::instance()->plugins().contains("socketcan")) {
     throw std::runtime_error("SocketCAN plugin not available");
   }
 
@@ -14,49 +43,217 @@ SocketCanStream::SocketCanStream(QObject* parent, SocketCanStreamConfig config_)
   }
 }
 
-bool SocketCanStream::available() { return QCanBus::instance()->plugins().contains("socketcan"); }
+SocketCanStream::~SocketCanStream() {
+  stop();
+  closeNative();
+}
+
+bool SocketCanStream::available() {
+  return nativeAvailable() || QCanBus::instance()->plugins().contains("socketcan");
+}
+
+bool SocketCanStream::nativeAvailable() {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
 
 bool SocketCanStream::connect() {
   // Connecting might generate some warnings about missing socketcan/libsocketcan libraries
   // These are expected and can be ignored, we don't need the advanced features of libsocketcan
-  QString errorString;
-  device.reset(QCanBus::instance()->createDevice("socketcan", config.device, &errorString));
-  device->setConfigurationParameter(QCanBusDevice::CanFdKey, true);
+  for (const QString& name : config.interfaces()) {
+    QString errorString;
+    std::unique_ptr<QCanBusDevice> device(QCanBus::instance()->createDevice("socketcan", name, &errorString));
+    if (!device) {
+      qDebug() << "Failed to create SocketCAN device" << name << errorString;
+      return false;
+    }
 
-  if (!device) {
-    qDebug() << "Failed to create SocketCAN device" << errorString;
-    return false;
+    device->setConfigurationParameter(QCanBusDevice::CanFdKey, true);
+    if (!device->connectDevice()) {
+      qDebug() << "Failed to connect to device" << name;
+      return false;
+    }
+    devices.push_back(std::move(device));
   }
+  return !devices.empty();
+}
 
-  if (!device->connectDevice()) {
-    qDebug() << "Failed to connect to device";
-    return false;
+void SocketCanStream::streamThread() {
+  if (config.native) {
+    nativeStreamThread();
+    return;
   }
 
-  return true;
+  while (!QThread::currentThread()->isInterruptionRequested()) {
+    QThread::msleep(1);
+
+    const uint64_t mono_ns = nanos_since_boot();
+    for (uint8_t bus = 0; bus < devices.size(); ++bus) {
+      for (const auto& frame : devices[bus]->readAllFrames()) {
+        if (!frame.isValid()) continue;
+
+        const auto payload = frame.payload();
+        handleFrame(bus, frame.frameId(), mono_ns, {(const uint8_t*)payload.constData(), (size_t)payload.size()});
+      }
+    }
+    commitFrames();
+  }
 }
 
-void SocketCanStream::streamThread() {
+#ifdef __linux__
+
+namespace {
+
+inline uint64_t toNs(const timespec& ts) { return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec; }
+
+inline int64_t realtimeToBootOffset() {
+  timespec rt;
+  clock_gettime(CLOCK_REALTIME, &rt);
+  return int64_t(nanos_since_boot()) - int64_t(toNs(rt));
+}
+
+}  // namespace
+
+bool SocketCanStream::connectNative() {
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd < 0) return false;
+
+  const QStringList names = config.interfaces();
+  for (int i = 0; i < names.size(); ++i) {
+    const int fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+    if (fd < 0) {
+      qDebug() << "Failed to create CAN socket:" << strerror(errno);
+      return false;
+    }
+    native_buses.push_back({.fd = fd});
+
+    // Best effort: older kernels only deliver classic frames, and a bigger receive buffer
+    // absorbs bursts while the reader is descheduled.
+    const int on = 1;
+    setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &on, sizeof(on));
+    const int rcvbuf = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    // Prefer hardware timestamps, fall back to kernel receive timestamps
+    const int ts_flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                         SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &ts_flags, sizeof(ts_flags)) < 0) {
+      setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+    }
+
+    sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = if_nametoindex(names[i].toStdString().c_str());
+    if (addr.can_ifindex == 0 || bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+      qDebug() << "Failed to bind CAN interface" << names[i] << strerror(errno);
+      return false;
+    }
+
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u32 = i;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) return false;
+  }
+  return !native_buses.empty();
+}
+
+void SocketCanStream::nativeStreamThread() {
+  constexpr int kBatchSize = 64;
+  constexpr int kPollTimeoutMs = 100;  // Bounds how long an interruption request can go unnoticed
+  constexpr int64_t kMaxHwDriftNs = 1'000'000;  // NIC clock error tolerated before it is re-anchored
+
+  canfd_frame frames[kBatchSize];
+  iovec iovs[kBatchSize];
+  mmsghdr msgs[kBatchSize];
+  alignas(cmsghdr) char control[kBatchSize][CMSG_SPACE(sizeof(timespec) * 3)];
+  epoll_event ready[16];
+  uint64_t last_mono_ns = 0;
+
   while (!QThread::currentThread()->isInterruptionRequested()) {
-    QThread::msleep(1);
+    const int n = epoll_wait(epoll_fd, ready, std::size(ready), kPollTimeoutMs);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      qWarning() << "epoll_wait failed:" << strerror(errno);
+      break;
+    }
+
+    for (int r = 0; r < n; ++r) {
+      const uint8_t src = ready[r].data.u32;
+      auto& bus = native_buses[src];
 
-    auto frames = device->readAllFrames();
-    if (frames.size() == 0) continue;
+      // Drain the socket in batches until it would block
+      while (true) {
+        for (int i = 0; i < kBatchSize; ++i) {
+          iovs[i] = {.iov_base = &frames[i], .iov_len = sizeof(canfd_frame)};
+          msgs[i].msg_hdr = {.msg_iov = &iovs[i], .msg_iovlen = 1,
+                             .msg_control = control[i], .msg_controllen = sizeof(control[i])};
+        }
+        const int received = recvmmsg(bus.fd, msgs, kBatchSize, MSG_DONTWAIT, nullptr);
+        if (received <= 0) break;
 
-    MessageBuilder msg;
-    auto evt = msg.initEvent();
-    auto canData = evt.initCan(frames.size());
+        const int64_t boot_offset = realtimeToBootOffset();
+        for (int i = 0; i < received; ++i) {
+          const canfd_frame& f = frames[i];
+          if (f.can_id & (CAN_ERR_FLAG | CAN_RTR_FLAG)) continue;
 
-    for (uint i = 0; i < frames.size(); i++) {
-      if (!frames[i].isValid()) continue;
+          uint64_t sw_ns = 0, hw_ns = 0;
+          for (cmsghdr* c = CMSG_FIRSTHDR(&msgs[i].msg_hdr); c; c = CMSG_NXTHDR(&msgs[i].msg_hdr, c)) {
+            if (c->cmsg_level != SOL_SOCKET) continue;
+            timespec ts[3] = {};
+            if (c->cmsg_type == SO_TIMESTAMPING) {
+              std::memcpy(ts, CMSG_DATA(c), sizeof(ts));
+              sw_ns = toNs(ts[0]);
+              hw_ns = toNs(ts[2]);
+            } else if (c->cmsg_type == SO_TIMESTAMPNS) {
+              std::memcpy(ts, CMSG_DATA(c), sizeof(timespec));
+              sw_ns = toNs(ts[0]);
+            }
+          }
 
-      canData[i].setAddress(frames[i].frameId());
-      canData[i].setSrc(0);
+          // Kernel timestamps are CLOCK_REALTIME; hardware ones run on the NIC clock, which drifts from it
+          const uint64_t sw_mono_ns = sw_ns ? sw_ns + boot_offset : nanos_since_boot();
+          uint64_t mono_ns = sw_mono_ns;
+          if (hw_ns) {
+            const int64_t drift = int64_t(hw_ns) + bus.hw_offset - int64_t(sw_mono_ns);
+            if (!bus.hw_synced || std::abs(drift) > kMaxHwDriftNs) {
+              bus.hw_offset = int64_t(sw_mono_ns) - int64_t(hw_ns);
+              bus.hw_synced = true;
+            }
+            mono_ns = hw_ns + bus.hw_offset;
+          }
+          // Buses are served in the order epoll reports them, so a frame can be older than one already
+          // queued from another bus. Live updates only move forward in time and would skip it.
+          mono_ns = std::max(mono_ns, last_mono_ns + 1);
+          last_mono_ns = mono_ns;
 
-      auto payload = frames[i].payload();
-      canData[i].setDat(kj::arrayPtr((uint8_t*)payload.data(), payload.size()));
+          const uint32_t address = f.can_id & ((f.can_id & CAN_EFF_FLAG) ? CAN_EFF_MASK : CAN_SFF_MASK);
+          handleFrame(src, address, mono_ns, {f.data, std::min<size_t>(f.len, CANFD_MAX_DLEN)});
+        }
+        if (received < kBatchSize) break;
+      }
     }
+    commitFrames();
+  }
+}
 
-    handleEvent(capnp::messageToFlatArray(msg));
+void SocketCanStream::closeNative() {
+  for (auto& bus : native_buses) {
+    if (bus.fd >= 0) close(bus.fd);
+  }
+  native_buses.clear();
+  if (epoll_fd >= 0) {
+    close(epoll_fd);
+    epoll_fd = -1;
   }
 }
+
+#else
+
+bool SocketCanStream::connectNative() { return false; }
+void SocketCanStream::nativeStreamThread() {}
+void SocketCanStream::closeNative() {}
+
+#endif
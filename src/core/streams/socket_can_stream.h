@@ -1,22 +1,28 @@
 #pragma once
 
+#include <QStringList>
 #include <QtSerialBus/QCanBus>
 #include <QtSerialBus/QCanBusDevice>
 #include <QtSerialBus/QCanBusDeviceInfo>
 #include <memory>
+#include <vector>
 
 #include "live_stream.h"
 
 struct SocketCanStreamConfig {
-  QString device = "";  // TODO: support multiple devices/buses at once
+  QString device = "";  // One or more comma separated interfaces; the n-th interface is reported as bus n
+  bool native = false;  // Read raw AF_CAN sockets (recvmmsg + kernel timestamps) instead of QtSerialBus
+
+  QStringList interfaces() const { return device.split(',', Qt::SkipEmptyParts); }
 };
 
 class SocketCanStream : public LiveStream {
   Q_OBJECT
  public:
   SocketCanStream(QObject* parent, SocketCanStreamConfig config_ = {});
-  ~SocketCanStream() { stop(); }
+  ~SocketCanStream();
   static bool available();
+  static bool nativeAvailable();
 
   inline QString routeName() const override { return QString("Live Streaming From Socket CAN %1").arg(config.device); }
 
@@ -25,5 +31,18 @@ class SocketCanStream : public LiveStream {
   bool connect();
 
   SocketCanStreamConfig config = {};
-  std::unique_ptr<QCanBusDevice> device;
+  std::vector<std::unique_ptr<QCanBusDevice>> devices;
+
+ private:
+  bool connectNative();
+  void nativeStreamThread();
+  void closeNative();
+
+  struct NativeBus {
+    int fd = -1;
+    int64_t hw_offset = 0;  // Maps the NIC clock onto nanos_since_boot, re-anchored when it drifts
+    bool hw_synced = false;
+  };
+  std::vector<NativeBus> native_buses;
+  int epoll_fd = -1;
 };
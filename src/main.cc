@@ -22,7 +22,14 @@ static AbstractStream* createStream(QCommandLineParser& p, QApplication* app) {
     }
   }
 
-  if (SocketCanStream::available() && p.isSet("socketcan")) return new SocketCanStream(app, {p.value("socketcan")});
+  if (SocketCanStream::available() && p.isSet("socketcan")) {
+    try {
+      return new SocketCanStream(app, {p.value("socketcan"), p.isSet("socketcan-native")});
+    } catch (const std::exception& e) {
+      qWarning() << e.what();
+      return nullptr;
+    }
+  }
 
   QString route = p.positionalArguments().value(0, p.isSet("demo") ? DEMO_ROUTE : "");
   if (!route.isEmpty()) {
@@ -85,11 +92,14 @@ int main(int argc, char* argv[]) {
                      {{"data_dir", "d"}, "local directory with routes", "data_dir"},
                      {"no-vipc", "do not output video"},
                      {{"dbc", "b"}, "dbc file to open", "dbc"}});
-  if (SocketCanStream::available())
+  if (SocketCanStream::available()) {
     parser.addOption({"socketcan",
                       "read can messages from given "
-                      "SocketCAN device",
+                      "SocketCAN device(s), comma separated",
                       "socketcan"});
+    if (SocketCanStream::nativeAvailable())
+      parser.addOption({"socketcan-native", "read SocketCAN through raw sockets with kernel timestamps"});
+  }
 
   parser.process(app);
 
@@ -10,6 +10,7 @@
 #include <QUndoView>
 #include <QVBoxLayout>
 #include <QWidgetAction>
+#include <algorithm>
 
 #include "core/commands/commands.h"
 #include "modules/dbc/dbc_controller.h"
@@ -78,8 +79,10 @@ void MainWindow::createFileMenu() {
   file_menu->addAction(tr("Open Stream..."), this, &MainWindow::selectAndOpenStream);
   close_stream_act_ = file_menu->addAction(tr("Close stream"), this, &MainWindow::closeStream);
   export_to_csv_act_ = file_menu->addAction(tr("Export to CSV..."), this, &MainWindow::exportToCSV);
+  export_to_columns_act_ = file_menu->addAction(tr("Export Signals to Columns..."), this, &MainWindow::exportToColumns);
   close_stream_act_->setEnabled(false);
   export_to_csv_act_->setEnabled(false);
+  export_to_columns_act_->setEnabled(false);
   file_menu->addSeparator();
 
   file_menu->addAction(tr("New DBC File"), QKeySequence::New, [this]() { dbc_controller_->newFile(); });
@@ -255,8 +258,27 @@ void MainWindow::closeStream() {
 void MainWindow::exportToCSV() {
   QString dir = QString("%1/%2.csv").arg(settings.last_dir).arg(StreamManager::stream()->routeName());
   QString fn = QFileDialog::getSaveFileName(this, "Export stream to CSV file", dir, tr("csv (*.csv)"));
-  if (!fn.isEmpty()) {
-    exportMessagesToCSV(fn);
+  if (!fn.isEmpty() && runExport(this, tr("Exporting to %1...").arg(fn),
+                                 [&fn](auto& progress) { return exportMessagesToCSV(fn, std::nullopt, progress); })) {
+    QMessageBox::information(this, tr("Export"), tr("Data successfully exported to:\n%1").arg(fn));
+  }
+}
+
+void MainWindow::exportToColumns() {
+  std::vector<MessageId> ids;
+  for (const auto& [id, events] : StreamManager::stream()->eventsMap()) {
+    if (!events.empty() && GetDBC()->msg(id)) ids.push_back(id);
+  }
+  std::sort(ids.begin(), ids.end());
+  if (ids.empty()) {
+    QMessageBox::information(this, tr("Export"), tr("No messages with DBC definitions to export."));
+    return;
+  }
+
+  QString dir = QString("%1/%2.bin").arg(settings.last_dir).arg(StreamManager::stream()->routeName());
+  QString fn = QFileDialog::getSaveFileName(this, "Export signals to columns", dir, tr("Columns (*.bin)"));
+  if (!fn.isEmpty() && runExport(this, tr("Exporting to %1...").arg(fn),
+                                 [&](auto& progress) { return exportSignalsToColumns(fn, ids, progress); })) {
     QMessageBox::information(this, tr("Export"), tr("Data successfully exported to:\n%1").arg(fn));
   }
 }
@@ -273,6 +295,7 @@ void MainWindow::openStream(AbstractStream* stream, const QString& dbc_file) {
 
   close_stream_act_->setEnabled(has_stream);
   export_to_csv_act_->setEnabled(has_stream);
+  export_to_columns_act_->setEnabled(has_stream);
   tools_menu_->setEnabled(has_stream);
 
   video_dock_->setWindowTitle(sm.stream()->routeName());
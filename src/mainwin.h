@@ -30,6 +30,7 @@ class MainWindow : public QMainWindow {
   void openStream(AbstractStream* stream, const QString& dbc_file = {});
   void closeStream();
   void exportToCSV();
+  void exportToColumns();
   void onStreamChanged();
 
  protected:
@@ -77,6 +78,7 @@ class MainWindow : public QMainWindow {
   QMenu* tools_menu_ = nullptr;
   QAction* close_stream_act_ = nullptr;
   QAction* export_to_csv_act_ = nullptr;
+  QAction* export_to_columns_act_ = nullptr;
   QAction* save_dbc_ = nullptr;
   QAction* save_dbc_as_ = nullptr;
   QAction* copy_dbc_to_clipboard_ = nullptr;
@@ -8,6 +8,7 @@
 #include <QRandomGenerator>
 #include <QStyle>
 
+#include "replay/include/util.h"
 #include "widgets/common.h"
 #include "widgets/tool_button.h"
 
@@ -30,6 +31,8 @@ Chart::Chart(QChartView* parent) : parent_(parent), QChart() {
 void Chart::setupConnections() {
   connect(axis_x_, &QValueAxis::rangeChanged, this, &Chart::updateAxisY);
   connect(axis_x_, &QValueAxis::rangeChanged, this, &Chart::updateSeriesPoints);
+  connect(axis_x_, &QValueAxis::rangeChanged, this, &Chart::updateSeriesLod);
+  connect(this, &QChart::plotAreaChanged, this, &Chart::updateSeriesLod);
   connect(axis_x_, &QValueAxis::rangeChanged, this, &Chart::resetCache);
   connect(axis_y_, &QValueAxis::rangeChanged, this, &Chart::resetCache);
   connect(axis_y_, &QAbstractAxis::titleTextChanged, this, &Chart::resetCache);
@@ -122,6 +125,7 @@ void Chart::takeSignals(std::vector<ChartSignal>&& source_sigs) {
   }
 
   std::move(source_sigs.begin(), source_sigs.end(), std::back_inserter(sigs_));
+  updateSeriesLod();
   syncUI();
 }
 
@@ -325,6 +329,13 @@ void Chart::updateSeriesPoints() {
   }
 }
 
+void Chart::updateSeriesLod() {
+  const int plot_width = plotArea().width();
+  for (auto& s : sigs_) {
+    s.updateSeries(series_type, axis_x_->min(), axis_x_->max(), plot_width);
+  }
+}
+
 void Chart::setSeriesType(SeriesType type) {
   if (type != series_type) {
     series_type = type;
@@ -334,9 +345,8 @@ void Chart::setSeriesType(SeriesType type) {
     }
     for (auto& s : sigs_) {
       s.series = createSeries(series_type, s.sig->color);
-      const auto& points = series_type == SeriesType::StepLine ? s.step_vals : s.vals;
-      s.series->replace(QVector<QPointF>(points.cbegin(), points.cend()));
     }
+    updateSeriesLod();
     syncUI();
 
     menu_->actions()[(int)type]->setChecked(true);
@@ -403,7 +413,7 @@ void Chart::setSeriesColor(QXYSeries* series, QColor color) {
   series->setColor(color);
 }
 
-void Chart::prepareData(const dbc::Signal* sig, const MessageEventsMap* msg_new_events) {
+void Chart::prepareData(const dbc::Signal* sig, const EventRangeMap* msg_new_events) {
   double min_x = axis_x_->min();
   double max_x = axis_x_->max();
   for (auto& s : sigs_) {
@@ -414,9 +424,10 @@ void Chart::prepareData(const dbc::Signal* sig, const MessageEventsMap* msg_new_
 }
 
 void Chart::updateSeries(const dbc::Signal* sig) {
+  const int plot_width = plotArea().width();
   for (auto& s : sigs_) {
     if (!sig || s.sig == sig) {
-      s.updateSeries(series_type);
+      s.updateSeries(series_type, axis_x_->min(), axis_x_->max(), plot_width);
     }
   }
   updateAxisY();
@@ -454,12 +465,13 @@ double Chart::getTooltipTextAt(double sec, QStringList& text_list) {
   for (auto& s : sigs_) {
     if (s.series->isVisible()) {
       QString value = "--";
-      // use reverse iterator to find last item <= sec.
-      auto it = std::lower_bound(s.vals.crbegin(), s.vals.crend(), sec, [](auto& p, double x) { return p.x() > x; });
-      if (it != s.vals.crend() && it->x() >= axis_x_->min()) {
-        value = s.sig->formatValue(it->y(), false);
-        s.track_pt = *it;
-        x = std::max(x, mapToPosition(*it).x());
+      // find last item <= sec.
+      const size_t i = s.vals.upperBound(sec);
+      if (i > 0 && s.vals.x(i - 1) >= axis_x_->min()) {
+        const QPointF pt = s.vals[i - 1];
+        value = s.sig->formatValue(pt.y(), false);
+        s.track_pt = pt;
+        x = std::max(x, mapToPosition(pt).x());
       }
       QString name = sigs_.size() > 1 ? s.sig->name + ": " : "";
       QString min = s.min_value == std::numeric_limits<double>::max() ? "--" : QString::number(s.min_value);
@@ -488,4 +500,9 @@ void Chart::updateMenu() {
       connect(act, &QAction::triggered, [this, id = sig.msg_id]() { emit openMessage(id); });
     }
   }
+
+  size_t bytes = 0;
+  for (const auto& s : sigs_) bytes += s.memoryUsage();
+  menu_->addSeparator();
+  menu_->addAction(tr("Memory: %1").arg(QString::fromStdString(formattedDataSize(bytes))))->setEnabled(false);
 }
@@ -17,7 +17,7 @@ class Chart : public QChart {
   void setTheme(QChart::ChartTheme theme);
   void removeIf(std::function<bool(const ChartSignal& s)> predicate);
 
-  void prepareData(const dbc::Signal* sig, const MessageEventsMap* msg_new_events = nullptr);
+  void prepareData(const dbc::Signal* sig, const EventRangeMap* msg_new_events = nullptr);
   void updateSeries(const dbc::Signal* sig = nullptr);
   bool updateAxisXRange(double min, double max);
   void handleSignalChange(const dbc::Signal* sig);
@@ -51,6 +51,7 @@ class Chart : public QChart {
   void resizeEvent(QGraphicsSceneResizeEvent* event) override;
   void setSeriesColor(QXYSeries* series, QColor color);
   void updateSeriesPoints();
+  void updateSeriesLod();
   void updateAxisY();
   QXYSeries* createSeries(SeriesType type, QColor color);
   std::pair<double, double> calculateValueRange(QString& common_unit);
@@ -347,11 +347,11 @@ void ChartView::drawForeground(QPainter* painter, const QRectF& rect) {
   painter->setPen(Qt::NoPen);
   for (auto& s : chart_->sigs_) {
     if (s.series->useOpenGL() && s.series->isVisible() && s.series->pointsVisible()) {
-      auto first = std::ranges::lower_bound(s.vals, chart_->axis_x_->min(), {}, &QPointF::x);
-      auto last = std::ranges::lower_bound(first, s.vals.end(), chart_->axis_x_->max(), {}, &QPointF::x);
+      const size_t first = s.vals.lowerBound(chart_->axis_x_->min());
+      const size_t last = s.vals.lowerBound(chart_->axis_x_->max(), first);
       painter->setBrush(s.series->color());
-      for (auto it = first; it != last; ++it) {
-        painter->drawEllipse(chart_->mapToPosition(*it), 4, 4);
+      for (size_t i = first; i < last; ++i) {
+        painter->drawEllipse(chart_->mapToPosition(s.vals[i]), 4, 4);
       }
     }
   }
@@ -407,9 +407,8 @@ void ChartView::drawSignalValue(QPainter* painter) {
   painter->setPen(chart_->legend()->labelColor());
   int i = 0;
   for (auto& s : chart_->sigs_) {
-    auto it = std::lower_bound(s.vals.crbegin(), s.vals.crend(), cur_sec,
-                               [](auto& p, double x) { return p.x() > x + EPSILON; });
-    QString value = (it != s.vals.crend() && it->x() >= chart_->axis_x_->min()) ? s.sig->formatValue(it->y()) : "--";
+    const size_t idx = s.vals.upperBound(cur_sec + EPSILON);
+    QString value = (idx > 0 && s.vals.x(idx - 1) >= chart_->axis_x_->min()) ? s.sig->formatValue(s.vals.y(idx - 1)) : "--";
     QRectF marker_rect = legend_markers[i++]->sceneBoundingRect();
     QRectF value_rect(marker_rect.bottomLeft() - QPoint(0, 1), marker_rect.size());
     QString elided_val = painter->fontMetrics().elidedText(value, Qt::ElideRight, value_rect.width());
@@ -78,7 +78,7 @@ void ChartsPanel::setupConnections() {
   connect(scroll_area_->verticalScrollBar(), &QScrollBar::valueChanged, this, &ChartsPanel::updateHoverFromCursor);
 }
 
-void ChartsPanel::eventsMerged(const MessageEventsMap& new_events) {
+void ChartsPanel::eventsMerged(const EventRangeMap& new_events) {
   if (charts.empty()) return;
 
   QtConcurrent::blockingMap(charts, [&new_events](ChartView* c) {
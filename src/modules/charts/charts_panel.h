@@ -58,7 +58,7 @@ class ChartsPanel : public QFrame {
   void handleChartDrop(ChartView* chart, ChartView* target, DropMode mode);
   ChartView* createChart(int pos = 0);
   void removeCharts(QList<ChartView*> charts_to_remove);
-  void eventsMerged(const MessageEventsMap& new_events);
+  void eventsMerged(const EventRangeMap& new_events);
   void updateState();
   void setMaxChartRange(int value);
   void updateLayout(bool force = false);
@@ -1,64 +1,129 @@
 #include "chart_signal.h"
 
+#include <cmath>
+
+#include "modules/system/signal_cache.h"
 #include "modules/system/stream_manager.h"
+#include "utils/m4.h"
 
-static void appendCanEvents(const dbc::Signal* sig, const std::vector<const CanEvent*>& events,
-                            std::vector<QPointF>& vals, std::vector<QPointF>& step_vals, SeriesBounds& series_bounds) {
-  vals.reserve(vals.size() + events.capacity());
-  step_vals.reserve(step_vals.size() + events.capacity() * 2);
+// Below this density the visible points are handed over as they are
+static constexpr int kMaxPointsPerPixel = 4;
 
-  double value = 0;
-  auto* can = StreamManager::stream();
-  for (const CanEvent* e : events) {
-    if (sig->parse(e->dat, e->size, &value)) {
-      const double ts = can->toSeconds(e->mono_ns);
-      vals.emplace_back(ts, value);
+void SignalSeries::reset(bool precise) {
+  precise_ = precise;
+  xs_.clear();
+  ys_.clear();
+  ys_precise_.clear();
+}
+
+void SignalSeries::reserve(size_t n) {
+  xs_.reserve(n);
+  precise_ ? ys_precise_.reserve(n) : ys_.reserve(n);
+}
+
+void SignalSeries::append(double sec, double value) {
+  xs_.push_back(sec);
+  precise_ ? ys_precise_.push_back(value) : ys_.push_back(value);
+}
+
+void SignalSeries::insert(size_t pos, const SignalSeries& other) {
+  xs_.insert(xs_.begin() + pos, other.xs_.begin(), other.xs_.end());
+  if (precise_) {
+    ys_precise_.insert(ys_precise_.begin() + pos, other.ys_precise_.begin(), other.ys_precise_.end());
+  } else {
+    ys_.insert(ys_.begin() + pos, other.ys_.begin(), other.ys_.end());
+  }
+}
 
-      series_bounds.addPoint(value);
+size_t SignalSeries::memoryUsage() const {
+  return xs_.capacity() * sizeof(double) + ys_.capacity() * sizeof(float) + ys_precise_.capacity() * sizeof(double);
+}
+
+// values holds the decoded value of each event, NaN where the signal is absent
+static void appendCanEvents(const CanEventRange& events, const double* values, SignalSeries& vals) {
+  vals.reserve(vals.size() + events.size());
 
-      if (!step_vals.empty()) step_vals.emplace_back(ts, step_vals.back().y());
-      step_vals.emplace_back(ts, value);
+  auto* can = StreamManager::stream();
+  for (auto it = events.begin(); it != events.end(); ++it, ++values) {
+    if (!std::isnan(*values)) {
+      vals.append(can->toSeconds(it.monoNs()), *values);
     }
   }
 }
 
-void ChartSignal::prepareData(const MessageEventsMap* msg_new_events, double min_x, double max_x) {
+void ChartSignal::prepareData(const EventRangeMap* msg_new_events, double min_x, double max_x) {
   // If no new events provided, we are doing a full refresh/clear
   if (!msg_new_events) {
-    vals.clear();
-    step_vals.clear();
+    vals.reset(needsPrecision(sig));
     series_bounds.clear();
   }
 
   auto* can = StreamManager::stream();
-  auto events = msg_new_events ? msg_new_events : &can->eventsMap();
-  auto it = events->find(msg_id);
-  if (it == events->end() || it->second.empty()) return;
-
-  if (vals.empty() || can->toSeconds(it->second.back()->mono_ns) > vals.back().x()) {
-    appendCanEvents(sig, it->second, vals, step_vals, series_bounds);
+  CanEventRange events;
+  if (msg_new_events) {
+    auto it = msg_new_events->find(msg_id);
+    if (it == msg_new_events->end()) return;
+    events = it->second;
   } else {
-    std::vector<QPointF> tmp_vals, tmp_step_vals;
-    appendCanEvents(sig, it->second, tmp_vals, tmp_step_vals, series_bounds);
-
-    auto insert_pos = std::ranges::lower_bound(vals, tmp_vals.front().x(), {}, &QPointF::x);
-    vals.insert(insert_pos, tmp_vals.begin(), tmp_vals.end());
+    const auto& all = can->events(msg_id);
+    events = {all.begin(), all.end()};
+  }
+  if (events.empty()) return;
 
-    auto step_insert_pos = std::ranges::lower_bound(step_vals, tmp_step_vals.front().x(), {}, &QPointF::x);
-    step_vals.insert(step_insert_pos, tmp_step_vals.begin(), tmp_step_vals.end());
+  const auto decoded = SignalCache::instance().get(msg_id, sig);
+  const double* values = decoded->values.data() + events.begin().index();
 
-    // Rebuild the bounds cache to ensure hierarchy is correct after insertion
-    series_bounds.clear();
-    for (const auto& p : vals) series_bounds.addPoint(p.y());
+  if (vals.empty() || can->toSeconds(events.back().mono_ns) > vals.back().x()) {
+    const size_t pos = vals.size();
+    appendCanEvents(events, values, vals);
+    series_bounds.insert(pos, vals.size() - pos, vals);
+  } else {
+    SignalSeries tmp_vals(needsPrecision(sig));
+    appendCanEvents(events, values, tmp_vals);
+    // None of the events may carry the signal, e.g. for another multiplexer value
+    if (tmp_vals.empty()) return;
+
+    const size_t pos = vals.lowerBound(tmp_vals.x(0));
+    vals.insert(pos, tmp_vals);
+    series_bounds.insert(pos, tmp_vals.size(), vals);
   }
 
   last_range_ = {-1.0, -1.0};
+  lod_dirty_ = true;
   updateRange(min_x, max_x);
 }
 
-void ChartSignal::updateSeries(SeriesType series_type) {
-  const auto& points = series_type == SeriesType::StepLine ? step_vals : vals;
-  series->replace(QList<QPointF>(points.begin(), points.end()));
+void ChartSignal::updateSeries(SeriesType series_type, double min_x, double max_x, int plot_width) {
+  const LodKey key{series_type, min_x, max_x, plot_width};
+  if (!lod_dirty_ && key == lod_key_) return;
+  lod_dirty_ = false;
+  lod_key_ = key;
+
+  // Keep one point beyond each edge so the line runs to the plot borders
+  size_t first = vals.lowerBound(min_x);
+  size_t last = vals.upperBound(max_x, first);
+  if (first > 0) --first;
+  if (last < vals.size()) ++last;
+
+  const bool decimate = plot_width > 0 && max_x > min_x && last - first > size_t(plot_width) * kMaxPointsPerPixel;
+  const bool step = series_type == SeriesType::StepLine;
+
+  QList<QPointF> lod;
+  lod.reserve((decimate ? plot_width * kMaxPointsPerPixel + 2 : last - first) * (step ? 2 : 1));
+  // Step lines are drawn by holding the previous value until the next sample
+  auto add = [&](size_t i) {
+    if (step && !lod.isEmpty()) lod.emplace_back(vals.x(i), lod.back().y());
+    lod.push_back(vals[i]);
+  };
+
+  if (decimate) {
+    decimateM4(
+        first, last, min_x, plot_width / (max_x - min_x), [&](size_t i) { return vals.x(i); },
+        [&](size_t i) { return vals.y(i); }, add);
+  } else {
+    for (size_t i = first; i < last; ++i) add(i);
+  }
+  series->replace(lod);
 }
 
 void ChartSignal::updateRange(double min_x, double max_x) {
@@ -73,11 +138,9 @@ void ChartSignal::updateRange(double min_x, double max_x) {
     return;
   }
 
-  auto first = std::ranges::lower_bound(vals, min_x, {}, &QPointF::x);
-  auto last = std::ranges::lower_bound(first, vals.end(), max_x, {}, &QPointF::x);
-
-  int l_idx = std::ranges::distance(vals.begin(), first);
-  int r_idx = std::ranges::distance(vals.begin(), last) - 1;
+  const size_t first = vals.lowerBound(min_x);
+  int l_idx = first;
+  int r_idx = (int)vals.lowerBound(max_x, first) - 1;
 
   if (l_idx <= r_idx) {
     // Hierarchical query is O(log N) for both Live and Log data
@@ -91,7 +154,7 @@ void ChartSignal::updatePointsVisible(double sec_per_px) {
   if (vals.size() < 2) return;
 
   // Average time between data points
-  double avg_period = (vals.back().x() - vals.front().x()) / vals.size();
+  double avg_period = (vals.back().x() - vals.x(0)) / vals.size();
 
   if (dynamic_cast<QScatterSeries*>(series)) {
     // Scale dot size by DPR so it looks consistent on all screens
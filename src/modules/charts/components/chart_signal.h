@@ -3,10 +3,10 @@
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QScatterSeries>
 #include <QtCharts/QValueAxis>
+#include <cmath>
 
 #include "core/dbc/dbc_manager.h"
 #include "core/streams/abstract_stream.h"
-#include "utils/segment_tree.h"
 #include "utils/series_bounds.h"
 
 // Define a small value of epsilon to compare double values
@@ -14,27 +14,83 @@ const float EPSILON = 0.000001;
 
 enum class SeriesType { Line = 0, StepLine, Scatter };
 
+/**
+ * @brief Time-ordered (seconds, value) samples of one signal, stored column-wise.
+ * Values are kept as float unless the signal is wider than a float mantissa, which
+ * brings a sample down to 12 bytes from the 48 the former line and step vectors took.
+ */
+class SignalSeries {
+ public:
+  explicit SignalSeries(bool precise = false) : precise_(precise) {}
+
+  inline size_t size() const { return xs_.size(); }
+  inline bool empty() const { return xs_.empty(); }
+  inline double x(size_t i) const { return xs_[i]; }
+  inline double y(size_t i) const { return precise_ ? ys_precise_[i] : ys_[i]; }
+  inline QPointF operator[](size_t i) const { return {x(i), y(i)}; }
+  inline QPointF back() const { return (*this)[size() - 1]; }
+
+  // Index of the first sample with x >= sec (resp. x > sec)
+  inline size_t lowerBound(double sec, size_t from = 0) const {
+    return std::lower_bound(xs_.begin() + from, xs_.end(), sec) - xs_.begin();
+  }
+  inline size_t upperBound(double sec, size_t from = 0) const {
+    return std::upper_bound(xs_.begin() + from, xs_.end(), sec) - xs_.begin();
+  }
+
+  void reset(bool precise);
+  void reserve(size_t n);
+  void append(double sec, double value);
+  void insert(size_t pos, const SignalSeries& other);
+  size_t memoryUsage() const;
+
+ private:
+  bool precise_ = false;
+  std::vector<double> xs_;
+  std::vector<float> ys_;
+  std::vector<double> ys_precise_;  // Replaces ys_ when precise_ is set
+};
+
 class ChartSignal {
  public:
   MessageId msg_id;
   const dbc::Signal* sig = nullptr;
   QXYSeries* series = nullptr;
-  std::vector<QPointF> vals;
-  std::vector<QPointF> step_vals;
+  SignalSeries vals;
   QPointF track_pt{};
   double min_value = 0;
   double max_value = 0;
 
 
-  ChartSignal(const MessageId& id, const dbc::Signal* s, QXYSeries* ser) : msg_id(id), sig(s), series(ser) {}
-  void prepareData(const MessageEventsMap* msg_new_events, double min_x, double max_x);
+  ChartSignal(const MessageId& id, const dbc::Signal* s, QXYSeries* ser)
+      : msg_id(id), sig(s), series(ser), vals(needsPrecision(s)) {}
+  void prepareData(const EventRangeMap* msg_new_events, double min_x, double max_x);
   void updateRange(double main_x, double max_x);
-  void updateSeries(SeriesType series_type);
+  // Hands QtCharts an M4-decimated copy of the visible range, rebuilt only when the data,
+  // the series type, the x range or the plot width changed since the last call.
+  void updateSeries(SeriesType series_type, double min_x, double max_x, int plot_width);
   void updatePointsVisible(double sec_per_px);
+  size_t memoryUsage() const { return vals.memoryUsage() + series_bounds.memoryUsage(); }
 
  private:
+  // Floats hold the values only if the physical range spans at most 2^24 steps of factor
+  static bool needsPrecision(const dbc::Signal* s) {
+    if (s->factor == 0) return false;
+    const double steps = (std::abs(s->offset) + std::ldexp(std::abs(s->factor), s->size)) / std::abs(s->factor);
+    return s->size > 24 || steps > (1 << 24);
+  }
+
   SeriesBounds series_bounds;
   std::pair<double, double> last_range_{0, 0};
+
+  struct LodKey {
+    SeriesType type = SeriesType::Line;
+    double min_x = 0, max_x = 0;
+    int plot_width = 0;
+    bool operator==(const LodKey&) const = default;
+  };
+  LodKey lod_key_;
+  bool lod_dirty_ = true;
 };
 
 qreal niceNumber(qreal x, bool ceiling);
@@ -4,11 +4,13 @@
 #include <QPainter>
 #include <QPalette>
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
+#include "modules/system/signal_cache.h"
 #include "modules/system/stream_manager.h"
 
-bool SparklineContext::update(const MessageId& msg_id, uint64_t current_ns, int time_window, const QSize& size) {
+bool SparklineContext::update(const MessageId& id, uint64_t current_ns, int time_window, const QSize& size) {
   const uint64_t range_ns = static_cast<uint64_t>(time_window) * 1000000000ULL;
   const float w = static_cast<float>(size.width());
   const float eff_w = std::max(1.0f, w - (2.0f * pad));
@@ -27,6 +29,7 @@ bool SparklineContext::update(const MessageId& msg_id, uint64_t current_ns, int
   }
 
   // Commit updates
+  msg_id = id;
   win_end_ns = current_ns;
   win_start_ns = (win_end_ns > range_ns) ? (win_end_ns - range_ns) : 0;
   const double ns_per_px_dbl = std::max(1.0, static_cast<double>(range_ns) / eff_w);
@@ -46,13 +49,13 @@ bool SparklineContext::update(const MessageId& msg_id, uint64_t current_ns, int
 
   auto* stream = StreamManager::stream();
   auto range =
-      stream->eventsInRange(msg_id, std::make_pair(stream->toSeconds(fetch_start), stream->toSeconds(win_end_ns)));
+      stream->eventsInRange(id, std::make_pair(stream->toSeconds(fetch_start), stream->toSeconds(win_end_ns)));
 
-  first = range.first;
-  last = range.second;
+  first = range.begin();
+  last = range.end();
 
   if (first != last) {
-    last_processed_mono_ns = (*(last - 1))->mono_ns;
+    last_processed_mono_ns = (last - 1)->mono_ns;
   } else if (jump_detected) {
     last_processed_mono_ns = win_end_ns;
   }
@@ -86,11 +89,14 @@ void Sparkline::update(const dbc::Signal* sig, const SparklineContext& ctx) {
 }
 
 void Sparkline::updateDataPoints(const dbc::Signal* sig, const SparklineContext& ctx) {
+  // Reuse the values if a chart or another view already decoded this signal
+  const auto decoded = SignalCache::instance().find(ctx.msg_id, sig);
   double val = 0.0;
   for (auto it = ctx.first; it != ctx.last; ++it) {
-    auto* e = *it;
-    if (sig->parse(e->dat, e->size, &val)) {
-      history_.push_back({e->mono_ns, val});
+    const CanEvent e = *it;
+    const bool valid = decoded ? !std::isnan(val = decoded->values[it.index()]) : sig->parse(e.dat, e.size, &val);
+    if (valid) {
+      history_.push_back({e.mono_ns, val});
       // Update running bounds
       if (val < min_val) min_val = val;
       if (val > max_val) max_val = val;
@@ -184,7 +190,7 @@ void Sparkline::flushBucket(int x, const Bucket& b) {
   addUniquePoint(x, b.entry);
 
   // Determine the order of min/max based on their timestamps
-  if (b.min_ts < b.max_ts) {
+  if (b.min_key < b.max_key) {
     if (b.min != b.entry && b.min != b.exit) addUniquePoint(x, b.min);
     if (b.max != b.entry && b.max != b.exit) addUniquePoint(x, b.max);
   } else {
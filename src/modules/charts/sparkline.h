@@ -7,6 +7,7 @@
 
 #include "core/dbc/dbc_message.h"
 #include "core/streams/abstract_stream.h"
+#include "utils/m4.h"
 
 // Size 32768 supports 30s of 1000Hz data
 template <typename T, size_t N = 32768>
@@ -47,6 +48,7 @@ class SparklineContext {
   bool jump_detected = false;
   float right_edge = 0.0f;
 
+  MessageId msg_id;
   CanEventIter first;
   CanEventIter last;
 
@@ -78,29 +80,7 @@ class Sparkline {
   double max_val = 0;
 
  private:
-  struct Bucket {
-    double entry = 0.0, exit = 0.0;
-    double min = std::numeric_limits<double>::max();
-    double max = std::numeric_limits<double>::lowest();
-    uint64_t min_ts = 0, max_ts = 0;
-
-    void init(double y, uint64_t ts) {
-      entry = exit = min = max = y;
-      min_ts = max_ts = ts;
-    }
-
-    void update(double y, uint64_t ts) {
-      exit = y;
-      if (y < min) {
-        min = y;
-        min_ts = ts;
-      }
-      if (y > max) {
-        max = y;
-        max_ts = ts;
-      }
-    }
-  };
+  using Bucket = M4Bucket<uint64_t>;
 
   void updateDataPoints(const dbc::Signal* sig, const SparklineContext& ctx);
   void mapHistoryToPoints(const SparklineContext& ctx);
@@ -1,43 +1,271 @@
 #include "export.h"
 
 #include <QFile>
-#include <QTextStream>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProgressDialog>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <numeric>
+#include <string>
 
+#include "modules/system/signal_cache.h"
 #include "modules/system/stream_manager.h"
 
-void exportMessagesToCSV(const QString& file_name, std::optional<MessageId> msg_id) {
+namespace {
+
+constexpr size_t kRowsPerTask = 1 << 16;
+constexpr char kColumnsMagic[8] = {'C', 'B', 'N', 'C', 'O', 'L', '0', '1'};
+
+// Appends CSV fields to one growing buffer, formatting numbers with std::to_chars
+class CsvBuffer {
+ public:
+  inline void put(char c) { buf_.push_back(c); }
+  inline void put(std::string_view s) { buf_.append(s); }
+  template <typename T>
+  void number(T v, int base = 10) {
+    char tmp[24];
+    buf_.append(tmp, std::to_chars(tmp, tmp + sizeof(tmp), v, base).ptr);
+  }
+  void fixed(double v, int precision) {
+    char tmp[512];  // Enough for any double with up to 100 decimals
+    buf_.append(tmp, std::to_chars(tmp, tmp + sizeof(tmp), v, std::chars_format::fixed, std::clamp(precision, 0, 100)).ptr);
+  }
+  void hex(const uint8_t* dat, int size) {
+    static constexpr char digits[] = "0123456789ABCDEF";
+    for (int i = 0; i < size; ++i) {
+      buf_.push_back(digits[dat[i] >> 4]);
+      buf_.push_back(digits[dat[i] & 0xf]);
+    }
+  }
+  inline std::string& str() { return buf_; }
+
+ private:
+  std::string buf_;
+};
+
+using FormatFn = std::function<void(uint64_t t0, uint64_t t1, CsvBuffer& out)>;
+
+// Splits [first, last] into windows of roughly kRowsPerTask of count evenly spread events
+std::vector<uint64_t> timeBounds(uint64_t first, uint64_t last, size_t count) {
+  const size_t tasks = std::max<size_t>(1, (count + kRowsPerTask - 1) / kRowsPerTask);
+  std::vector<uint64_t> bounds(tasks + 1);
+  for (size_t i = 0; i < tasks; ++i) bounds[i] = first + (last - first) / tasks * i;
+  bounds[tasks] = last + 1;
+  return bounds;
+}
+
+// Formats the windows [bounds[i], bounds[i + 1]) on worker threads, a batch at a time, and appends
+// them to file in order. prepare runs on the calling thread before each batch, since progress
+// reports may process events and merge new ones into the store.
+bool writeWindows(QFile& file, const std::vector<uint64_t>& bounds, const FormatFn& format,
+                  const ExportProgress& progress, const std::function<void()>& prepare = {}) {
+  const int tasks = bounds.size() - 1;
+  const int batch = std::max(1, QThread::idealThreadCount()) * 2;
+  for (int first = 0; first < tasks; first += batch) {
+    if (prepare) prepare();
+
+    std::vector<int> windows(std::min(batch, tasks - first));
+    std::iota(windows.begin(), windows.end(), first);
+    auto blocks = QtConcurrent::blockingMapped<std::vector<std::string>>(windows, [&](int i) {
+      CsvBuffer out;
+      format(bounds[i], bounds[i + 1], out);
+      return std::move(out.str());
+    });
+
+    for (const auto& block : blocks) {
+      if (file.write(block.data(), block.size()) != (qint64)block.size()) return false;
+    }
+    if (progress && !progress(first + windows.size(), tasks)) return false;
+  }
+  return true;
+}
+
+bool finish(QFile& file, bool ok) {
+  if (!ok) file.remove();
+  return ok;
+}
+
+}  // namespace
+
+bool exportMessagesToCSV(const QString& file_name, std::optional<MessageId> msg_id, const ExportProgress& progress) {
   QFile file(file_name);
-  if (file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
-    QTextStream stream(&file);
-    stream << "time,addr,bus,data\n";
-    auto* can = StreamManager::stream();
-    for (auto e : msg_id ? can->events(*msg_id) : can->allEvents()) {
-      stream << QString::number(can->toSeconds(e->mono_ns), 'f', 3) << ","
-             << "0x" << QString::number(e->address, 16) << "," << e->src << ","
-             << "0x" << QByteArray::fromRawData((const char*)e->dat, e->size).toHex().toUpper() << "\n";
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+  auto* can = StreamManager::stream();
+  auto write_event = [can](const CanEvent& e, CsvBuffer& out) {
+    out.fixed(can->toSeconds(e.mono_ns), 3);
+    out.put(",0x");
+    out.number(e.address, 16);
+    out.put(',');
+    out.number(e.src);
+    out.put(",0x");
+    out.hex(e.dat, e.size);
+    out.put('\n');
+  };
+
+  std::vector<uint64_t> bounds;
+  FormatFn format;
+  if (msg_id) {
+    const auto& events = can->events(*msg_id);
+    if (!events.empty()) bounds = timeBounds(events.monoNs(0), events.back().mono_ns, events.size());
+    format = [&, id = *msg_id](uint64_t t0, uint64_t t1, CsvBuffer& out) {
+      const auto& evs = can->events(id);
+      auto last = evs.begin() + evs.lowerBound(t1);
+      for (auto it = evs.begin() + evs.lowerBound(t0); it != last; ++it) write_event(*it, out);
+    };
+  } else {
+    uint64_t first = std::numeric_limits<uint64_t>::max(), last = 0;
+    size_t count = 0;
+    for (const auto& [_, events] : can->eventsMap()) {
+      if (events.empty()) continue;
+      first = std::min(first, events.monoNs(0));
+      last = std::max(last, events.back().mono_ns);
+      count += events.size();
     }
+    if (count > 0) bounds = timeBounds(first, last, count);
+    format = [&](uint64_t t0, uint64_t t1, CsvBuffer& out) {
+      can->forEachEvent(t0, t1 - 1, [&](const CanEvent& e) { write_event(e, out); });
+    };
+  }
+
+  const char header[] = "time,addr,bus,data\n";
+  bool ok = file.write(header, sizeof(header) - 1) == sizeof(header) - 1;
+  if (ok && !bounds.empty()) ok = writeWindows(file, bounds, format, progress);
+  return finish(file, ok);
+}
+
+bool exportSignalsToCSV(const QString& file_name, const MessageId& msg_id, const ExportProgress& progress) {
+  auto msg = GetDBC()->msg(msg_id);
+  if (!msg || msg->sigs.empty()) return false;
+
+  QFile file(file_name);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+  CsvBuffer header;
+  header.put("time,addr,bus");
+  for (auto s : msg->sigs) {
+    header.put(',');
+    header.put(s->name.toStdString());
+  }
+  header.put('\n');
+  bool ok = file.write(header.str().data(), header.str().size()) == (qint64)header.str().size();
+
+  auto* can = StreamManager::stream();
+  const auto& events = can->events(msg_id);
+  if (ok && !events.empty()) {
+    const std::vector<const dbc::Signal*> sigs(msg->sigs.begin(), msg->sigs.end());
+    std::vector<std::shared_ptr<const DecodedSignal>> decoded;
+    auto format = [&](uint64_t t0, uint64_t t1, CsvBuffer& out) {
+      const auto& evs = can->events(msg_id);
+      const size_t last = evs.lowerBound(t1);
+      for (size_t i = evs.lowerBound(t0); i < last; ++i) {
+        const CanEvent e = evs[i];
+        out.fixed(can->toSeconds(e.mono_ns), 3);
+        out.put(",0x");
+        out.number(e.address, 16);
+        out.put(',');
+        out.number(e.src);
+        for (size_t k = 0; k < sigs.size(); ++k) {
+          // Signals absent from this frame are written as 0
+          const double value = decoded[k]->values[i];
+          out.put(',');
+          out.fixed(std::isnan(value) ? 0.0 : value, sigs[k]->precision);
+        }
+        out.put('\n');
+      }
+    };
+    // Refetched per batch so the values stay in step with the event indices
+    auto prepare = [&]() { decoded = SignalCache::instance().get(msg_id, sigs, msg); };
+    ok = writeWindows(file, timeBounds(events.monoNs(0), events.back().mono_ns, events.size()), format, progress,
+                      prepare);
   }
+  return finish(file, ok);
 }
 
-void exportSignalsToCSV(const QString& file_name, const MessageId& msg_id) {
+bool exportSignalsToColumns(const QString& file_name, const std::vector<MessageId>& ids,
+                            const ExportProgress& progress) {
   QFile file(file_name);
-  if (auto msg = GetDBC()->msg(msg_id);
-      msg && msg->sigs.size() && file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
-    QTextStream stream(&file);
-    stream << "time,addr,bus";
-    for (auto s : msg->sigs) stream << "," << s->name;
-    stream << "\n";
-
-    auto* can = StreamManager::stream();
-    for (auto e : can->events(msg_id)) {
-      stream << QString::number(can->toSeconds(e->mono_ns), 'f', 3) << ","
-             << "0x" << QString::number(e->address, 16) << "," << e->src;
-      for (auto s : msg->sigs) {
-        double value = 0;
-        s->parse(e->dat, e->size, &value);
-        stream << "," << QString::number(value, 'f', s->precision);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+  struct Table {
+    MessageId id;
+    std::vector<uint64_t> mono_ns;
+    std::vector<const dbc::Signal*> sigs;
+    std::vector<std::vector<double>> values;
+  };
+  auto* can = StreamManager::stream();
+  auto decode = [can](const MessageId& id) {
+    Table t{id};
+    const auto& events = can->events(id);
+    t.mono_ns.reserve(events.size());
+    for (const auto& chunk : events.chunks()) {
+      t.mono_ns.insert(t.mono_ns.end(), chunk.timestamps().begin(), chunk.timestamps().end());
+    }
+    if (auto msg = GetDBC()->msg(id)) {
+      t.sigs.assign(msg->sigs.begin(), msg->sigs.end());
+      t.values.assign(t.sigs.size(), std::vector<double>(events.size()));
+      std::vector<double*> out(t.sigs.size());
+      for (size_t k = 0; k < out.size(); ++k) out[k] = t.values[k].data();
+      SignalCache::decode(msg, t.sigs, events, 0, events.size(), out);
+    }
+    return t;
+  };
+
+  // All elements are 8 bytes wide, so every column stays 8-byte aligned
+  const QString order = std::endian::native == std::endian::little ? "<" : ">";
+  QJsonArray columns;
+  qint64 offset = sizeof(kColumnsMagic);
+  auto write_column = [&](const MessageId& id, const QString& name, const QString& dtype, const void* data,
+                          size_t count) {
+    const qint64 bytes = count * 8;
+    columns.append(QJsonObject{{"message", id.toString()},
+                               {"name", name},
+                               {"dtype", order + dtype},
+                               {"offset", offset},
+                               {"count", (qint64)count}});
+    offset += bytes;
+    return file.write((const char*)data, bytes) == bytes;
+  };
+
+  bool ok = file.write(kColumnsMagic, sizeof(kColumnsMagic)) == sizeof(kColumnsMagic);
+  const size_t batch = std::max(1, QThread::idealThreadCount());
+  for (size_t first = 0; ok && first < ids.size(); first += batch) {
+    const std::vector<MessageId> group(ids.begin() + first, ids.begin() + std::min(first + batch, ids.size()));
+    const auto tables = QtConcurrent::blockingMapped<std::vector<Table>>(group, decode);
+    for (size_t i = 0; ok && i < tables.size(); ++i) {
+      const auto& t = tables[i];
+      ok = write_column(t.id, "mono_ns", "u8", t.mono_ns.data(), t.mono_ns.size());
+      for (size_t k = 0; ok && k < t.sigs.size(); ++k) {
+        ok = write_column(t.id, t.sigs[k]->name, "f8", t.values[k].data(), t.values[k].size());
       }
-      stream << "\n";
     }
+    if (ok && progress) ok = progress(first + group.size(), ids.size());
+  }
+
+  if (ok) {
+    const QJsonObject footer{{"begin_mono_ns", (qint64)can->beginMonoNs()}, {"columns", columns}};
+    const QByteArray json = QJsonDocument(footer).toJson(QJsonDocument::Compact);
+    const uint64_t json_size = json.size();
+    ok = file.write(json) == json.size() &&
+         file.write((const char*)&json_size, sizeof(json_size)) == sizeof(json_size) &&
+         file.write(kColumnsMagic, sizeof(kColumnsMagic)) == sizeof(kColumnsMagic);
   }
+  return finish(file, ok);
+}
+
+bool runExport(QWidget* parent, const QString& label, const std::function<bool(const ExportProgress&)>& export_fn) {
+  QProgressDialog dlg(label, QObject::tr("Cancel"), 0, 0, parent);
+  dlg.setWindowModality(Qt::WindowModal);
+  dlg.setMinimumDuration(500);
+  return export_fn([&dlg](int done, int total) {
+    dlg.setMaximum(total);
+    dlg.setValue(done);
+    return !dlg.wasCanceled();
+  });
 }
@@ -1,8 +1,36 @@
 #pragma once
 
+#include <QWidget>
+#include <functional>
 #include <optional>
+#include <vector>
 
 #include "core/dbc/dbc_manager.h"
 
-void exportMessagesToCSV(const QString& file_name, std::optional<MessageId> msg_id = std::nullopt);
-void exportSignalsToCSV(const QString& file_name, const MessageId& msg_id);
+// Reports (done, total) steps of an export. Returning false cancels it.
+using ExportProgress = std::function<bool(int done, int total)>;
+
+// Exports return false when they fail or are canceled, after removing the partial file
+bool exportMessagesToCSV(const QString& file_name, std::optional<MessageId> msg_id = std::nullopt,
+                         const ExportProgress& progress = {});
+bool exportSignalsToCSV(const QString& file_name, const MessageId& msg_id, const ExportProgress& progress = {});
+
+/**
+ * @brief Writes the timestamps and decoded signals of each message in ids as raw columns, for
+ * readers that mmap the file (e.g. numpy.frombuffer). Layout:
+ *
+ *   "CBNCOL01"                  magic
+ *   columns                     native-endian arrays, each 8-byte aligned
+ *   footer                      UTF-8 JSON: {"begin_mono_ns", "columns": [{"message", "name",
+ *                               "dtype" (numpy style, e.g. "<f8"), "offset", "count"}]}
+ *   uint64 footer size
+ *   "CBNCOL01"
+ *
+ * Every message contributes a "mono_ns" column followed by one column per signal; frames that
+ * don't carry a signal hold NaN.
+ */
+bool exportSignalsToColumns(const QString& file_name, const std::vector<MessageId>& ids,
+                            const ExportProgress& progress = {});
+
+// Runs export under a modal, cancellable progress dialog. Returns its result.
+bool runExport(QWidget* parent, const QString& label, const std::function<bool(const ExportProgress&)>& export_fn);
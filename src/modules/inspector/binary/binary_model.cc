@@ -28,6 +28,7 @@ const BinaryModel::Item* BinaryModel::getItem(const QModelIndex& index) const {
 
 void BinaryModel::setMessage(const MessageId& message_id) {
   msg_id = message_id;
+  bit_flip_tracker.index.clear();
   rebuild();
 }
 
@@ -51,7 +52,7 @@ void BinaryModel::rebuild() {
 }
 
 void BinaryModel::initializeItems() {
-  bit_flip_tracker = {};
+  bit_flip_tracker.time_range.reset();
   items.clear();
 
   auto snapshot = StreamManager::stream()->snapshot(msg_id);
@@ -280,40 +281,25 @@ QColor BinaryModel::calculateBitHeatColor(Item& item, uint32_t flips, float log_
                 static_cast<int>(min_alpha * inv_i + 220 * i));
 }
 
-const std::array<std::array<uint32_t, 8>, MAX_CAN_LEN>& BinaryModel::getBitFlipChanges(size_t msg_size) {
-  // Return cached results if time range and data are unchanged
+const BitFlipCounts& BinaryModel::getBitFlipChanges(size_t msg_size) {
   auto* stream = StreamManager::stream();
   auto time_range = stream->timeRange();
   if (!time_range) {
     time_range = {stream->minSeconds(), stream->maxSeconds()};
   }
 
-  if (bit_flip_tracker.time_range == time_range && !bit_flip_tracker.flip_counts.empty())
+  // Return cached results if time range and data are unchanged
+  const auto& events = stream->events(msg_id);
+  if (bit_flip_tracker.time_range == time_range && bit_flip_tracker.msg_size == msg_size &&
+      bit_flip_tracker.index.size() == events.size())
     return bit_flip_tracker.flip_counts;
 
   bit_flip_tracker.time_range = time_range;
-  bit_flip_tracker.flip_counts.fill({});
+  bit_flip_tracker.msg_size = msg_size;
+  bit_flip_tracker.index.sync(events);
 
-  // Iterate over events within the specified time range and calculate bit flips
   auto [first, last] = stream->eventsInRange(msg_id, time_range);
-  if (std::distance(first, last) <= 1) return bit_flip_tracker.flip_counts;
-
-  std::vector<uint8_t> prev_values((*first)->dat, (*first)->dat + (*first)->size);
-  for (auto it = std::next(first); it != last; ++it) {
-    const CanEvent* event = *it;
-    int size = std::min<int>(msg_size, event->size);
-    for (int i = 0; i < size; ++i) {
-      const uint8_t diff = event->dat[i] ^ prev_values[i];
-      if (!diff) continue;
-
-      auto& bit_flips = bit_flip_tracker.flip_counts[i];
-      for (int bit = 0; bit < 8; ++bit) {
-        if (diff & (1u << bit)) ++bit_flips[7 - bit];
-      }
-      prev_values[i] = event->dat[i];
-    }
-  }
-
+  bit_flip_tracker.index.count(events, first.index(), last.index(), msg_size, bit_flip_tracker.flip_counts);
   return bit_flip_tracker.flip_counts;
 }
 
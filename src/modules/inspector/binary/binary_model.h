@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "core/dbc/dbc_manager.h"
+#include "core/streams/bit_flip_index.h"
 #include "core/streams/message_state.h"
 
 // 32-32px is the "sweet spot" for technical touch interfaces
@@ -45,7 +46,7 @@ class BinaryModel : public QAbstractTableModel {
   void updateState();
   void updateSignalCells(const dbc::Signal* sig);
   QSet<const dbc::Signal*> getOverlappingSignals() const;
-  const std::array<std::array<uint32_t, 8>, MAX_CAN_LEN>& getBitFlipChanges(size_t msg_size);
+  const BitFlipCounts& getBitFlipChanges(size_t msg_size);
 
   // QAbstractTableModel overrides
   QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
@@ -61,7 +62,9 @@ class BinaryModel : public QAbstractTableModel {
  private:
   struct BitFlipTracker {
     std::optional<std::pair<double, double>> time_range;
-    std::array<std::array<uint32_t, 8>, MAX_CAN_LEN> flip_counts;
+    size_t msg_size = 0;
+    BitFlipIndex index;
+    BitFlipCounts flip_counts = {};
   } bit_flip_tracker;
 
   int row_count = 0;
@@ -1,6 +1,12 @@
 #include "history_model.h"
 
+#include <QtConcurrent>
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
 #include <functional>
+#include <limits>
 
 #include "core/dbc/dbc_manager.h"
 #include "modules/message_list/message_delegate.h"
@@ -8,19 +14,114 @@
 
 static const size_t LIVE_VIEW_LIMIT = 500;
 
+// MessageHistoryModel::MatchIndex
+
+void MessageHistoryModel::MatchIndex::append(bool match) {
+  if (size % 64 == 0) {
+    ranks.push_back(bits.empty() ? 0 : ranks.back() + std::popcount(bits.back()));
+    bits.push_back(0);
+  }
+  bits.back() |= uint64_t(match) << (size % 64);
+  ++size;
+}
+
+size_t MessageHistoryModel::MatchIndex::rank(size_t i) const {
+  const size_t w = i / 64;
+  if (w >= bits.size()) return bits.empty() ? 0 : ranks.back() + std::popcount(bits.back());
+  return ranks[w] + std::popcount(bits[w] & ((1ULL << (i % 64)) - 1));
+}
+
+size_t MessageHistoryModel::MatchIndex::select(size_t n) const {
+  // The last word with fewer than n + 1 matches before it holds the match
+  const size_t w = std::ranges::upper_bound(ranks, n) - ranks.begin() - 1;
+  uint64_t word = bits[w];
+  for (size_t k = n - ranks[w]; k > 0; --k) word &= word - 1;
+  return w * 64 + std::countr_zero(word);
+}
+
+// MessageHistoryModel
+
+MessageHistoryModel::MessageHistoryModel(QObject* parent) : QAbstractTableModel(parent) {
+  connect(&StreamManager::instance(), &StreamManager::eventsMerged, this, &MessageHistoryModel::eventsMerged);
+  connect(&match_watcher_, &QFutureWatcher<MatchIndex>::finished, this, [this]() {
+    if (match_watcher_.isCanceled()) return;
+    matches_ = match_watcher_.result();
+    matches_ready_ = true;
+    updateState(true);
+  });
+}
+
+MessageHistoryModel::~MessageHistoryModel() {
+  if (pinned_) SignalCache::instance().unpin(msg_id);
+}
+
+// Past the last event while the match index is being built
+size_t MessageHistoryModel::eventIndex(int row) const {
+  if (!filter_cmp) return end_ - 1 - row;
+  if (!matches_ready_) return std::numeric_limits<size_t>::max();
+  return matches_.select(matches_.rank(end_) - 1 - row);
+}
+
+size_t MessageHistoryModel::totalRows() const {
+  if (!filter_cmp) return end_;
+  return matches_ready_ ? matches_.rank(std::min(end_, matches_.size)) : 0;
+}
+
+const MessageHistoryModel::LogEntry* MessageHistoryModel::getItem(const QModelIndex& index) const {
+  if (!index.isValid() || index.row() >= row_count) return nullptr;
+
+  const size_t i = eventIndex(index.row());
+  if (auto it = row_cache_.find(i); it != row_cache_.end()) return &it->second;
+
+  auto* stream = StreamManager::stream();
+  const auto& events = stream->events(msg_id);
+  if (i >= events.size()) return nullptr;
+  if (row_cache_.size() >= kRowCacheSize) row_cache_.clear();
+
+  auto& entry = row_cache_[i];
+  const CanEvent e = events[i];
+  entry.mono_ns = e.mono_ns;
+  entry.size = e.size;
+  std::copy_n(e.dat, std::min<int>(e.size, MAX_CAN_LEN), entry.data.begin());
+
+  if (isHexMode()) {
+    // Replay the frames just before this one to color the bytes as the live view would
+    MessageState state;
+    const double freq = stream->snapshot(msg_id)->freq;
+    for (auto f = events.begin() + (i > kColorWindow ? i - kColorWindow : 0); f.index() <= i; ++f) {
+      const CanEvent prev = *f;
+      state.update(prev.dat, prev.size, prev.mono_ns / 1e9, freq);
+    }
+    state.updateAllPatternColors(e.mono_ns / 1e9);
+    for (int k = 0; k < state.size; ++k) {
+      entry.colors[k] = state.color(k);
+    }
+  }
+  return &entry;
+}
+
 QVariant MessageHistoryModel::data(const QModelIndex& index, int role) const {
-  if (!index.isValid() || index.row() >= (int)messages.size()) return {};
+  if (!index.isValid() || index.row() >= row_count) return {};
 
-  const auto& m = messages[index.row()];
   const int col = index.column();
-
   if (role == Qt::DisplayRole) {
-    if (col == 0) return QString::number(StreamManager::stream()->toSeconds(m.mono_ns), 'f', 3);
+    auto* stream = StreamManager::stream();
+    const auto& events = stream->events(msg_id);
+    const size_t i = eventIndex(index.row());
+    if (i >= events.size()) return {};
+
+    if (col == 0) return QString::number(stream->toSeconds(events.monoNs(i)), 'f', 3);
     if (isHexMode()) return {};  // Handled by delegate
 
     const int sig_idx = col - 1;
-    if (sig_idx < (int)m.sig_values.size()) {
-      return sigs[sig_idx].sig->formatValue(m.sig_values[sig_idx], false);
+    if (sig_idx < (int)sigs.size()) {
+      // The message's entries are pinned, so this is a lookup even under memory pressure. Holding the series
+      // instead would copy it on every merge.
+      const auto decoded = SignalCache::instance().get(msg_id, sigs[sig_idx].sig);
+      // Empty for frames that don't carry the signal
+      if (i < decoded->values.size() && !std::isnan(decoded->values[i])) {
+        return sigs[sig_idx].sig->formatValue(decoded->values[i], false);
+      }
     }
   } else if (role == ColumnTypeRole::IsHexColumn) {
     return isHexMode() && col == 1;
@@ -29,7 +130,11 @@ QVariant MessageHistoryModel::data(const QModelIndex& index, int role) const {
 }
 
 void MessageHistoryModel::setMessage(const MessageId& message_id) {
+  auto& cache = SignalCache::instance();
+  if (pinned_) cache.unpin(msg_id);
   msg_id = message_id;
+  cache.pin(msg_id);
+  pinned_ = true;
   rebuild();
 }
 
@@ -37,11 +142,19 @@ void MessageHistoryModel::setPauseState(bool paused) {
   if (is_paused == paused) return;
   is_paused = paused;
 
-  if (!is_paused) {
+  if (is_paused) {
+    // Paused: every row down to the first event can be scrolled to
+    const int all = std::min<size_t>(total_, INT_MAX);
+    if (all > row_count) {
+      beginInsertRows({}, row_count, all - 1);
+      row_count = all;
+      endInsertRows();
+    }
+  } else {
     // Transitioning back to Live: Prune the list to the live limit immediately
-    if (messages.size() > LIVE_VIEW_LIMIT) {
-      beginRemoveRows({}, LIVE_VIEW_LIMIT, messages.size() - 1);
-      messages.erase(messages.begin() + LIVE_VIEW_LIMIT, messages.end());
+    if (row_count > LIVE_VIEW_LIMIT) {
+      beginRemoveRows({}, LIVE_VIEW_LIMIT, row_count - 1);
+      row_count = LIVE_VIEW_LIMIT;
       endRemoveRows();
     }
     updateState(false);
@@ -57,12 +170,22 @@ void MessageHistoryModel::rebuild() {
       sigs.push_back({display_name, s});
     }
   }
-  messages.clear();
-  hex_colors = {};
+  prefetchSignals();
+  row_cache_.clear();
+  end_ = total_ = 0;
+  row_count = 0;
   endResetModel();
   setFilter(0, "", nullptr);
 }
 
+// Decodes the missing columns in one pass over the events, so the cells find them in the cache
+void MessageHistoryModel::prefetchSignals() {
+  std::vector<const dbc::Signal*> columns;
+  columns.reserve(sigs.size());
+  for (const auto& s : sigs) columns.push_back(s.sig);
+  if (!columns.empty()) SignalCache::instance().get(msg_id, columns, GetDBC()->msg(msg_id));
+}
+
 QVariant MessageHistoryModel::headerData(int section, Qt::Orientation orientation, int role) const {
   if (orientation != Qt::Horizontal || section < 0) return {};
 
@@ -94,89 +217,87 @@ void MessageHistoryModel::setHexMode(bool hex) {
 void MessageHistoryModel::setFilter(int sig_idx, const QString& value, std::function<bool(double, double)> cmp) {
   filter_sig_idx = sig_idx;
   filter_value = value.toDouble();
-  filter_cmp = value.isEmpty() ? nullptr : cmp;
+  filter_cmp = value.isEmpty() || sig_idx < 0 || sig_idx >= (int)sigs.size() ? nullptr : cmp;
+  buildMatches();
   updateState(true);
 }
 
-void MessageHistoryModel::updateState(bool clear) {
-  if (clear && !messages.empty()) {
-    beginRemoveRows({}, 0, messages.size() - 1);
-    messages.clear();
-    hex_colors = {};
-    endRemoveRows();
+// Scans the filter signal on a worker thread. Rows appear once the scan is done.
+void MessageHistoryModel::buildMatches() {
+  matches_ = {};
+  matches_ready_ = false;
+  if (!filter_cmp) {
+    match_watcher_.setFuture({});
+    return;
   }
 
-  auto* stream = StreamManager::stream();
-  uint64_t current_time = stream->toMonoNs(stream->snapshot(msg_id)->ts) + 1;
-  uint64_t last_time = messages.empty() ? 0 : messages.front().mono_ns;
-
-  // Insert at index 0 (top of the list)
-  fetchData(0, current_time, last_time);
+  // The rows map through the old index
+  setTotal(0, true);
+  // The series is only held while it is scanned
+  auto series = SignalCache::instance().get(msg_id, sigs[filter_sig_idx].sig);
+  scan_size_ = series->values.size();
+  auto scan = [series = std::move(series), cmp = filter_cmp, value = filter_value]() {
+    MatchIndex m;
+    m.bits.reserve(series->values.size() / 64 + 1);
+    m.ranks.reserve(series->values.size() / 64 + 1);
+    for (double v : series->values) m.append(!std::isnan(v) && cmp(v, value));
+    return m;
+  };
+  match_watcher_.setFuture(QtConcurrent::run(scan));
+}
 
-  if (!is_paused && messages.size() > LIVE_VIEW_LIMIT) {
-    beginRemoveRows({}, LIVE_VIEW_LIMIT, messages.size() - 1);
-    messages.erase(messages.begin() + LIVE_VIEW_LIMIT, messages.end());
-    endRemoveRows();
+// Extends the match index over events appended since it was built
+void MessageHistoryModel::syncMatches() {
+  const auto series = SignalCache::instance().get(msg_id, sigs[filter_sig_idx].sig);
+  const auto& values = series->values;
+  for (size_t i = matches_.size; i < values.size(); ++i) {
+    matches_.append(!std::isnan(values[i]) && filter_cmp(values[i], filter_value));
   }
 }
 
-bool MessageHistoryModel::canFetchMore(const QModelIndex& parent) const {
-  // Strategy: Only allow fetching older history when paused to prevent list jumps
-  if (!is_paused || messages.empty()) return false;
-
-  const auto& events = StreamManager::stream()->events(msg_id);
-  if (events.empty()) return false;
+void MessageHistoryModel::eventsMerged(const EventRangeMap& new_events) {
+  auto it = new_events.find(msg_id);
+  if (it == new_events.end()) return;
 
-  return messages.back().mono_ns > events.front()->mono_ns;
+  const size_t pos = it->second.begin().index();
+  // Events inserted among the scanned ones shift the matches
+  if (filter_cmp && pos < (matches_ready_ ? matches_.size : scan_size_)) buildMatches();
+  // Events inserted before the current time move the rows; appends show up on the next update
+  if (pos < end_) updateState(true);
 }
 
-void MessageHistoryModel::fetchMore(const QModelIndex& parent) {
-  if (messages.empty()) return;
-  // Fetch older data at the end (Infinite Scroll)
-  fetchData((int)messages.size(), messages.back().mono_ns, 0);
-}
-
-void MessageHistoryModel::fetchData(int insert_pos_idx, uint64_t from_time, uint64_t min_time) {
+void MessageHistoryModel::updateState(bool clear) {
   auto* stream = StreamManager::stream();
   const auto& events = stream->events(msg_id);
-  if (events.empty()) return;
-
-  auto first =
-      std::lower_bound(events.rbegin(), events.rend(), from_time, [](auto e, uint64_t ts) { return e->mono_ns > ts; });
-
-  std::vector<MessageHistoryModel::LogEntry> msgs;
-  std::vector<double> values(sigs.size());
-  msgs.reserve(batch_size);
-  for (; first != events.rend(); ++first) {
-    const CanEvent* e = *first;
-    if (e->mono_ns <= min_time) break;
+  end_ = events.upperBound(stream->toMonoNs(stream->snapshot(msg_id)->ts) + 1);
+  if (filter_cmp && matches_ready_) syncMatches();
+  setTotal(totalRows(), clear);
+}
 
-    for (int i = 0; i < sigs.size(); ++i) {
-      sigs[i].sig->parse(e->dat, e->size, &values[i]);
-    }
-    if (!filter_cmp || filter_cmp(values[filter_sig_idx], filter_value)) {
-      auto& m = msgs.emplace_back(LogEntry{e->mono_ns, values, e->size});
-      std::copy_n(e->dat, std::min<int>(e->size, MAX_CAN_LEN), m.data.begin());
-      if (msgs.size() >= batch_size && min_time == 0) {
-        break;
-      }
-    }
+// New rows are the newest events, so they are inserted at the top
+void MessageHistoryModel::setTotal(size_t total, bool reset) {
+  if ((reset || total < total_) && row_count > 0) {
+    beginRemoveRows({}, 0, row_count - 1);
+    row_count = 0;
+    endRemoveRows();
+  }
+  if (reset || total < total_) {
+    total_ = 0;
+    row_cache_.clear();
   }
 
-  if (!msgs.empty()) {
-    if (isHexMode() && (min_time > 0 || messages.empty())) {
-      const auto freq = stream->snapshot(msg_id)->freq;
-      for (auto it = msgs.rbegin(); it != msgs.rend(); ++it) {
-        double ts = it->mono_ns / 1e9;
-        hex_colors.update(it->data.data(), it->size, ts, freq);
-        hex_colors.updateAllPatternColors(ts);
-        it->colors = hex_colors.colors;
-      }
-    }
-
-    beginInsertRows({}, insert_pos_idx, insert_pos_idx + msgs.size() - 1);
-    messages.insert(messages.begin() + insert_pos_idx, std::make_move_iterator(msgs.begin()),
-                    std::make_move_iterator(msgs.end()));
+  const size_t limit = is_paused ? INT_MAX : LIVE_VIEW_LIMIT;
+  if (total > total_) {
+    const int added = std::min(total - total_, limit);
+    beginInsertRows({}, 0, added - 1);
+    total_ = total;
+    row_count += added;
     endInsertRows();
+
+    if (row_count > limit) {
+      beginRemoveRows({}, limit, row_count - 1);
+      row_count = limit;
+      endRemoveRows();
+    }
   }
 }
@@ -1,12 +1,21 @@
 #pragma once
 #include <QAbstractTableModel>
 #include <QColor>
-#include <deque>
+#include <QFutureWatcher>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "core/dbc/dbc_manager.h"
 #include "core/streams/message_state.h"
+#include "modules/system/signal_cache.h"
 
+/**
+ * @brief Virtual history of one message, newest first. Rows map to event indices, so the model
+ * holds no per-row data: cells are looked up in the signal cache, where the message is pinned, and
+ * hex rows are built only when painted. A filtered view maps rows through a match bitmap built on a
+ * worker thread.
+ */
 class MessageHistoryModel : public QAbstractTableModel {
   Q_OBJECT
 
@@ -18,25 +27,21 @@ class MessageHistoryModel : public QAbstractTableModel {
 
   struct LogEntry {
     uint64_t mono_ns = 0;
-    std::vector<double> sig_values;
     uint8_t size = 0;
-    std::array<uint8_t, MAX_CAN_LEN> data;
-    std::array<uint32_t, MAX_CAN_LEN> colors;
+    std::array<uint8_t, MAX_CAN_LEN> data = {};
+    std::array<uint32_t, MAX_CAN_LEN> colors = {};
   };
 
-  MessageHistoryModel(QObject* parent) : QAbstractTableModel(parent) {}
+  MessageHistoryModel(QObject* parent);
+  ~MessageHistoryModel() override;
   void setMessage(const MessageId& message_id);
   void updateState(bool clear = false);
   void setFilter(int sig_idx, const QString& value, std::function<bool(double, double)> cmp);
   QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
-  const LogEntry *getItem(const QModelIndex& index) const {
-    if (!index.isValid() || index.row() >= static_cast<int>(messages.size())) return nullptr;
-    return &messages[index.row()];
-  }
+  // Valid until the next call
+  const LogEntry* getItem(const QModelIndex& index) const;
   QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
-  void fetchMore(const QModelIndex& parent) override;
-  bool canFetchMore(const QModelIndex& parent) const override;
-  int rowCount(const QModelIndex& parent = QModelIndex()) const override { return messages.size(); }
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override { return row_count; }
   int columnCount(const QModelIndex& parent = QModelIndex()) const override {
     return !isHexMode() ? sigs.size() + 1 : 2;
   }
@@ -47,18 +52,45 @@ class MessageHistoryModel : public QAbstractTableModel {
   void setResumed() { setPauseState(false); }
   const std::vector<SignalColumn>& messageSignals() const { return sigs; }
   void setPauseState(bool paused);
-  void fetchData(int insert_pos_idx, uint64_t from_time, uint64_t min_time);
 
   MessageId msg_id;
 
  private:
-  MessageState hex_colors;
-  const int batch_size = 50;
+  // Events that pass the filter, with a running count per word to find the n-th match
+  struct MatchIndex {
+    std::vector<uint64_t> bits;
+    std::vector<uint32_t> ranks;  // Matches before each word
+    size_t size = 0;              // Events covered
+    void append(bool match);
+    size_t rank(size_t i) const;  // Matches among events [0, i)
+    size_t select(size_t n) const;  // Index of the n-th match, counting from 0
+  };
+
+  void eventsMerged(const EventRangeMap& new_events);
+  void buildMatches();
+  void syncMatches();
+  void prefetchSignals();
+  size_t eventIndex(int row) const;
+  size_t totalRows() const;
+  void setTotal(size_t total, bool reset);
+
+  static constexpr int kRowCacheSize = 512;
+  static constexpr int kColorWindow = 16;  // Earlier frames replayed to color a hex row
+
   int filter_sig_idx = -1;
   double filter_value = 0;
   std::function<bool(double, double)> filter_cmp = nullptr;
-  std::deque<LogEntry> messages;
   std::vector<SignalColumn> sigs;
   bool hex_mode = false;
   bool is_paused = false;
+  bool pinned_ = false;  // Whether msg_id is pinned in the signal cache
+
+  size_t end_ = 0;    // Events up to the current time
+  size_t total_ = 0;  // Rows before the live view limit
+  int row_count = 0;
+  MatchIndex matches_;
+  bool matches_ready_ = false;
+  size_t scan_size_ = 0;  // Events covered by the scan in flight
+  QFutureWatcher<MatchIndex> match_watcher_;
+  mutable std::unordered_map<size_t, LogEntry> row_cache_;
 };
@@ -137,10 +137,12 @@ void MessageHistory::exportToCSV() {
   QString fn = QFileDialog::getSaveFileName(this, tr("Export %1 to CSV").arg(msg), defaultPath, tr("CSV (*.csv)"));
   if (fn.isEmpty()) return;
 
-  if (model->isHexMode())
-    exportMessagesToCSV(fn, model->msg_id);
-  else
-    exportSignalsToCSV(fn, model->msg_id);
-
-  QMessageBox::information(this, tr("Export Success"), tr("Successfully exported to:\n%1").arg(fn));
+  const MessageId id = model->msg_id;
+  const bool hex_mode = model->isHexMode();
+  bool ok = runExport(this, tr("Exporting %1...").arg(msg), [&](auto& progress) {
+    return hex_mode ? exportMessagesToCSV(fn, id, progress) : exportSignalsToCSV(fn, id, progress);
+  });
+  if (ok) {
+    QMessageBox::information(this, tr("Export Success"), tr("Successfully exported to:\n%1").arg(fn));
+  }
 }
@@ -1,14 +1,24 @@
 #include "message_model.h"
 
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
 #include <QPalette>
 #include <cmath>
+#include <numeric>
+#include <set>
 #include <unordered_set>
 
 #include "message_delegate.h"
 #include "modules/settings/settings.h"
 #include "modules/system/stream_manager.h"
 
+// Above this many rows out of order, refresh() reorders in one layout change
+static constexpr int kMaxRowMoves = 32;
+
+// Per-update cost of the list, enabled with QT_LOGGING_RULES="cabana.messagelist.debug=true"
+Q_LOGGING_CATEGORY(lcMessageModel, "cabana.messagelist", QtInfoMsg)
+
 static const QString NA = QStringLiteral("N/A");
 static const QString DASH = QStringLiteral("\u2014");  // Em dash
 
@@ -221,17 +231,14 @@ std::vector<MessageModel::Item> MessageModel::fetchItems() const {
         .address_hex = addr_hex,
     };
 
-    if (match(item)) {
-      new_items.push_back(std::move(item));
-    }
+    new_items.push_back(std::move(item));
   };
 
-  // Process live snapshots
+  // Process live snapshots. Inactive ones are kept too: activity changes between rebuilds, so
+  // filterItems() decides whether they are shown.
   for (const auto& [id, data] : snapshots) {
     snapshot_addrs.insert(id.address);
-    if (show_inactive_ || (data && data->is_active)) {
-      processItem(id, dbc->msg(id), data.get());
-    }
+    processItem(id, dbc->msg(id), data.get());
   }
 
   // Process DBC placeholders
@@ -243,12 +250,22 @@ std::vector<MessageModel::Item> MessageModel::fetchItems() const {
     }
   }
 
-  sortItems(new_items);
   return new_items;
 }
 
+std::vector<MessageModel::Item> MessageModel::filterItems() const {
+  std::vector<Item> items;
+  items.reserve(candidates_.size());
+  std::ranges::copy_if(candidates_, std::back_inserter(items), [this](const Item& item) {
+    return (show_inactive_ || !item.data || item.data->is_active) && match(item);
+  });
+  sortItems(items);
+  return items;
+}
+
 void MessageModel::rebuild() {
-  std::vector<Item> new_items = fetchItems();
+  candidates_ = fetchItems();
+  std::vector<Item> new_items = filterItems();
 
   dbc_msg_count_ = 0;
   signal_count_ = 0;
@@ -274,24 +291,173 @@ void MessageModel::rebuild() {
     emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
     emit layoutChanged();
   }
+  updateRowIndex();
+}
+
+void MessageModel::refresh() {
+  std::vector<Item> next = filterItems();
+  std::unordered_map<MessageId, int> target;
+  target.reserve(next.size());
+  for (int i = 0; i < next.size(); ++i) target.emplace(next[i].id, i);
+
+  // Drop rows that no longer match, a contiguous run at a time from the bottom
+  int removed = 0;
+  for (int last = (int)items_.size() - 1; last >= 0; --last) {
+    if (target.contains(items_[last].id)) continue;
+    int first = last;
+    while (first > 0 && !target.contains(items_[first - 1].id)) --first;
+    beginRemoveRows({}, first, last);
+    items_.erase(items_.begin() + first, items_.begin() + last + 1);
+    endRemoveRows();
+    removed += last - first + 1;
+    last = first;
+  }
+
+  // Rows on the longest run already in target order stay put; only the others are moved
+  std::vector<int> order(items_.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = target[items_[i].id];
+  std::vector<int> tails, prev(order.size(), -1);  // Patience sorting over row indices
+  for (int i = 0; i < order.size(); ++i) {
+    auto it = std::ranges::lower_bound(tails, order[i], {}, [&](int row) { return order[row]; });
+    if (it != tails.begin()) prev[i] = *std::prev(it);
+    if (it == tails.end()) {
+      tails.push_back(i);
+    } else {
+      *it = i;
+    }
+  }
+  std::vector<char> placed(order.size(), 0);
+  for (int i = tails.empty() ? -1 : tails.back(); i >= 0; i = prev[i]) placed[i] = 1;
+
+  std::vector<int> pending;
+  for (int i = 0; i < order.size(); ++i) {
+    if (!placed[i]) pending.push_back(order[i]);
+  }
+  std::ranges::sort(pending);
+
+  const int moved = pending.size();
+  if (moved > std::max<int>(kMaxRowMoves, order.size() / 16)) {
+    // Many rows moved: one layout change is cheaper than a move notification per row
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    std::vector<int> rows(order.size());  // Old row of each new row
+    std::iota(rows.begin(), rows.end(), 0);
+    std::ranges::sort(rows, {}, [&](int row) { return order[row]; });
+    std::vector<int> new_row(rows.size());
+    std::vector<Item> sorted;
+    sorted.reserve(rows.size());
+    for (int i = 0; i < rows.size(); ++i) {
+      new_row[rows[i]] = i;
+      sorted.push_back(std::move(items_[rows[i]]));
+    }
+    items_ = std::move(sorted);
+
+    const QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    to.reserve(from.size());
+    for (const auto& idx : from) to.append(index(new_row[idx.row()], idx.column()));
+    changePersistentIndexList(from, to);
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+  } else {
+    // Current row of each target position, and the targets of rows already in order
+    std::vector<int> row_of(next.size());
+    for (int i = 0; i < order.size(); ++i) row_of[order[i]] = i;
+    std::set<int> placed_targets;
+    for (int i = 0; i < order.size(); ++i) {
+      if (placed[i]) placed_targets.insert(order[i]);
+    }
+
+    for (int t : pending) {
+      const int from = row_of[t];
+
+      // In front of the first placed row that sorts after it
+      const auto after = placed_targets.upper_bound(t);
+      const int to = after != placed_targets.end() ? row_of[*after] : (int)order.size();
+      if (to != from && to != from + 1) {
+        beginMoveRows({}, from, from, {}, to);
+        const int dest = to > from ? to - 1 : to;
+        auto rotate = [&](auto& v) {
+          if (dest > from) {
+            std::rotate(v.begin() + from, v.begin() + from + 1, v.begin() + dest + 1);
+          } else {
+            std::rotate(v.begin() + dest, v.begin() + from, v.begin() + from + 1);
+          }
+        };
+        rotate(items_);
+        rotate(order);
+        for (int i = std::min(from, dest); i <= std::max(from, dest); ++i) row_of[order[i]] = i;
+        endMoveRows();
+      }
+      placed_targets.insert(t);
+    }
+  }
+
+  // items_ is now a subsequence of next. Insert what is missing, a contiguous run at a time.
+  int inserted = 0;
+  for (int i = 0; i < next.size(); ++i) {
+    if (i < items_.size() && items_[i].id == next[i].id) continue;
+    int last = i;
+    while (last + 1 < next.size() && (i >= items_.size() || next[last + 1].id != items_[i].id)) ++last;
+    beginInsertRows({}, i, last);
+    items_.insert(items_.begin() + i, next.begin() + i, next.begin() + last + 1);
+    endInsertRows();
+    inserted += last - i + 1;
+    i = last;
+  }
+
+  items_ = std::move(next);
+  updateRowIndex();
+  qCDebug(lcMessageModel) << "refresh: removed" << removed << "moved" << moved << "inserted" << inserted;
+}
+
+void MessageModel::updateRowIndex() {
+  rows_.clear();
+  rows_.reserve(items_.size());
+  for (int i = 0; i < items_.size(); ++i) rows_.emplace(items_[i].id, i);
+}
+
+void MessageModel::emitRowsChanged(std::vector<int>& rows) {
+  std::ranges::sort(rows);
+  for (size_t i = 0; i < rows.size();) {
+    size_t j = i + 1;
+    while (j < rows.size() && rows[j] == rows[j - 1] + 1) ++j;
+    emit dataChanged(index(rows[i], Column::FREQ), index(rows[j - 1], Column::DATA));
+    i = j;
+  }
 }
 
 void MessageModel::onSnapshotsUpdated(const std::set<MessageId>* ids, bool needs_rebuild) {
-  if (needs_rebuild ||
-      ((filters_.contains(Column::FREQ) || filters_.contains(Column::COUNT) || filters_.contains(Column::DATA)) &&
-       ++sort_threshold_ == settings.fps)) {
+  if (needs_rebuild) {
     sort_threshold_ = 0;
     rebuild();
     return;
   }
 
-  for (int i = 0; i < items_.size(); ++i) {
-    if (!ids || ids->contains(items_[i].id)) {
-      for (int c = Column::FREQ; c <= Column::DATA; ++c) {
-        emit dataChanged(index(i, c), index(i, c));
-      }
+  QElapsedTimer timer;
+  timer.start();
+
+  // Filters and sort keys on live columns, and activity when inactive messages are hidden, are
+  // re-evaluated about once a second
+  const bool live_keys = filters_.contains(Column::FREQ) || filters_.contains(Column::COUNT) ||
+                         filters_.contains(Column::DATA) || sort_column == Column::FREQ ||
+                         sort_column == Column::COUNT || !show_inactive_;
+  if (live_keys && ++sort_threshold_ >= settings.fps) {
+    sort_threshold_ = 0;
+    refresh();
+  }
+
+  if (items_.empty()) return;
+  if (!ids) {
+    emit dataChanged(index(0, Column::FREQ), index(rowCount() - 1, Column::DATA));
+  } else {
+    std::vector<int> rows;
+    rows.reserve(ids->size());
+    for (const auto& id : *ids) {
+      if (auto it = rows_.find(id); it != rows_.end()) rows.push_back(it->second);
     }
+    emitRowsChanged(rows);
   }
+  qCDebug(lcMessageModel) << "update:" << (ids ? ids->size() : items_.size()) << "dirty of" << items_.size()
+                          << "rows in" << timer.nsecsElapsed() / 1000 << "us";
 }
 
 void MessageModel::sort(int column, Qt::SortOrder order) {
@@ -300,6 +466,7 @@ void MessageModel::sort(int column, Qt::SortOrder order) {
     sort_order = order;
     emit layoutAboutToBeChanged();
     sortItems(items_);
+    updateRowIndex();
     emit layoutChanged();
   }
 }
@@ -3,6 +3,7 @@
 #include <QAbstractTableModel>
 #include <QMap>
 #include <QVariant>
+#include <unordered_map>
 #include <vector>
 
 #include "core/dbc/dbc_manager.h"
@@ -33,8 +34,8 @@ class MessageModel : public QAbstractTableModel {
   inline int getDbcMessageCount() const { return dbc_msg_count_; }
   inline int getSignalCount() const { return signal_count_; }
   inline int getRowForMessageId(const MessageId& id) const {
-    auto it = std::ranges::find(items_, id, &Item::id);
-    return (it != items_.end()) ? std::distance(items_.begin(), it) : -1;
+    auto it = rows_.find(id);
+    return it != rows_.end() ? it->second : -1;
   }
   void setFilterStrings(const QMap<int, QString>& filters);
   void setInactiveMessagesVisible(bool show);
@@ -57,11 +58,18 @@ class MessageModel : public QAbstractTableModel {
 
   std::optional<FilterRange> parseFilter(QString filter, int base = 10);
   std::vector<Item> fetchItems() const;
+  std::vector<Item> filterItems() const;
   void sortItems(std::vector<MessageModel::Item>& items) const;
+  // Brings items_ to the current filter and sort order with row removes, moves and inserts
+  void refresh();
+  void updateRowIndex();
+  void emitRowsChanged(std::vector<int>& rows);
   bool match(const MessageModel::Item& id) const;
   QString formatFreq(const Item& item) const;
 
   std::vector<Item> items_;
+  std::vector<Item> candidates_;  // Every listable message before filtering, active or not, refreshed by rebuild()
+  std::unordered_map<MessageId, int> rows_;
   QMap<int, QString> filters_;
   QMap<int, FilterRange> filter_ranges_;
   bool show_inactive_ = true;
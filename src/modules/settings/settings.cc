@@ -15,6 +15,10 @@ void settings_op(SettingOperation op) {
   op(s, "absolute_time", settings.absolute_time);
   op(s, "fps", settings.fps);
   op(s, "max_cached_minutes", settings.max_cached_minutes);
+  op(s, "cache_can_index", settings.cache_can_index);
+  op(s, "can_index_cache_mb", settings.can_index_cache_mb);
+  op(s, "signal_cache_mb", settings.signal_cache_mb);
+  op(s, "seek_checkpoint_mb", settings.seek_checkpoint_mb);
   op(s, "chart_height", settings.chart_height);
   op(s, "chart_range", settings.chart_range);
   op(s, "chart_column_count", settings.chart_column_count);
@@ -30,6 +34,7 @@ void settings_op(SettingOperation op) {
   op(s, "sparkline_range", settings.sparkline_range);
   op(s, "log_livestream", settings.log_livestream);
   op(s, "log_path", settings.log_path);
+  op(s, "log_compression", (int&)settings.log_compression);
   op(s, "drag_direction", (int&)settings.drag_direction);
   op(s, "recent_dbc_file", settings.recent_dbc_file);
   op(s, "active_msg_id", settings.active_msg_id);
@@ -18,6 +18,11 @@ class Settings : public QObject {
     AlwaysLE,
     AlwaysBE,
   };
+  enum LogCompression {
+    LogUncompressed,
+    LogZstd,
+    LogBzip2,
+  };
 
   Settings();
   ~Settings();
@@ -25,6 +30,10 @@ class Settings : public QObject {
   bool absolute_time = false;
   int fps = 10;
   int max_cached_minutes = 30;
+  bool cache_can_index = true;
+  int can_index_cache_mb = 4096;  // Disk budget for cached CAN index files, oldest used are removed first
+  int signal_cache_mb = 512;  // Memory budget for decoded signal values shared by charts and views
+  int seek_checkpoint_mb = 256;  // Memory budget for the message states kept to make seeks exact
   int chart_height = 200;
   int chart_column_count = 1;
   int chart_range = 3 * 60;  // 3 minutes
@@ -33,6 +42,7 @@ class Settings : public QObject {
   int sparkline_range = 15;  // 15 seconds
   bool log_livestream = true;
   QString log_path;
+  LogCompression log_compression = LogUncompressed;  // Applied to finished live stream log segments
   QString last_dir;
   QString last_route_dir;
   QByteArray geometry;
@@ -34,6 +34,32 @@ SettingsDialog::SettingsDialog(QWidget* parent) : QDialog(parent) {
   cached_minutes->setRange(MIN_CACHE_MINIUTES, MAX_CACHE_MINIUTES);
   cached_minutes->setSingleStep(1);
   cached_minutes->setValue(settings.max_cached_minutes);
+
+  form_layout->addRow(tr("Cache CAN Index"), cache_can_index = new QCheckBox(this));
+  cache_can_index->setToolTip(
+      tr("Store extracted CAN events on disk so reopened routes skip extracting them from the logs"));
+  cache_can_index->setChecked(settings.cache_can_index);
+
+  form_layout->addRow(tr("CAN Index Cache Size"), can_index_cache_mb = new QSpinBox(this));
+  can_index_cache_mb->setToolTip(tr("Disk space for cached CAN indexes. The least recently used are removed first"));
+  can_index_cache_mb->setRange(256, 1024 * 1024);
+  can_index_cache_mb->setSingleStep(256);
+  can_index_cache_mb->setSuffix(" MB");
+  can_index_cache_mb->setValue(settings.can_index_cache_mb);
+
+  form_layout->addRow(tr("Signal Cache Size"), signal_cache_mb = new QSpinBox(this));
+  signal_cache_mb->setToolTip(tr("Memory used to keep decoded signal values for charts, history and export"));
+  signal_cache_mb->setRange(64, 8192);
+  signal_cache_mb->setSingleStep(64);
+  signal_cache_mb->setSuffix(" MB");
+  signal_cache_mb->setValue(settings.signal_cache_mb);
+
+  form_layout->addRow(tr("Seek Checkpoint Size"), seek_checkpoint_mb = new QSpinBox(this));
+  seek_checkpoint_mb->setToolTip(tr("Memory used to keep message states along the route for exact seeks"));
+  seek_checkpoint_mb->setRange(16, 4096);
+  seek_checkpoint_mb->setSingleStep(16);
+  seek_checkpoint_mb->setSuffix(" MB");
+  seek_checkpoint_mb->setValue(settings.seek_checkpoint_mb);
   main_layout->addWidget(groupbox);
 
   groupbox = new QGroupBox("New Signal Settings");
@@ -58,6 +84,10 @@ SettingsDialog::SettingsDialog(QWidget* parent) : QDialog(parent) {
   log_path->setReadOnly(true);
   auto browse_btn = new QPushButton(tr("B&rowse..."));
   path_layout->addWidget(browse_btn);
+  path_layout->addWidget(log_compression = new QComboBox(this));
+  log_compression->setToolTip(tr("Compression applied to finished log segments"));
+  log_compression->addItems({tr("Uncompressed"), tr("zstd"), tr("bzip2")});
+  log_compression->setCurrentIndex(settings.log_compression);
   main_layout->addWidget(log_livestream);
 
   auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
@@ -83,9 +113,14 @@ void SettingsDialog::save() {
   }
   settings.fps = fps->value();
   settings.max_cached_minutes = cached_minutes->value();
+  settings.cache_can_index = cache_can_index->isChecked();
+  settings.can_index_cache_mb = can_index_cache_mb->value();
+  settings.signal_cache_mb = signal_cache_mb->value();
+  settings.seek_checkpoint_mb = seek_checkpoint_mb->value();
   settings.chart_height = chart_height->value();
   settings.log_livestream = log_livestream->isChecked();
   settings.log_path = log_path->text();
+  settings.log_compression = (Settings::LogCompression)log_compression->currentIndex();
   settings.drag_direction = (Settings::DragDirection)drag_direction->currentIndex();
   emit settings.changed();
   QDialog::accept();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDialog>
 #include <QGroupBox>
@@ -12,10 +13,15 @@ class SettingsDialog : public QDialog {
   void save();
   QSpinBox* fps;
   QSpinBox* cached_minutes;
+  QCheckBox* cache_can_index;
+  QSpinBox* can_index_cache_mb;
+  QSpinBox* signal_cache_mb;
+  QSpinBox* seek_checkpoint_mb;
   QSpinBox* chart_height;
   QComboBox* chart_series_type;
   QComboBox* theme;
   QGroupBox* log_livestream;
   QLineEdit* log_path;
+  QComboBox* log_compression;
   QComboBox* drag_direction;
 };
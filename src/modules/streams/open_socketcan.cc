@@ -14,6 +14,8 @@ OpenSocketCanWidget::OpenSocketCanWidget(QWidget* parent) : AbstractStreamWidget
 
   QHBoxLayout* device_layout = new QHBoxLayout();
   device_edit = new QComboBox();
+  device_edit->setEditable(true);
+  device_edit->setToolTip(tr("Separate multiple interfaces with commas, e.g. can0,can1. The n-th interface is bus n."));
   device_edit->setFixedWidth(300);
   device_layout->addWidget(device_edit);
 
@@ -21,6 +23,10 @@ OpenSocketCanWidget::OpenSocketCanWidget(QWidget* parent) : AbstractStreamWidget
   refresh->setFixedWidth(100);
   device_layout->addWidget(refresh);
   form_layout->addRow(tr("Device"), device_layout);
+
+  native_check = new QCheckBox(tr("Raw sockets with kernel timestamps"));
+  native_check->setVisible(SocketCanStream::nativeAvailable());
+  form_layout->addRow("", native_check);
   main_layout->addLayout(form_layout);
 
   main_layout->addStretch(1);
@@ -28,6 +34,7 @@ OpenSocketCanWidget::OpenSocketCanWidget(QWidget* parent) : AbstractStreamWidget
 
   connect(refresh, &QPushButton::clicked, this, &OpenSocketCanWidget::refreshDevices);
   connect(device_edit, &QComboBox::currentTextChanged, this, [=] { config.device = device_edit->currentText(); });
+  connect(native_check, &QCheckBox::toggled, this, [=](bool checked) { config.native = checked; });
 
   // Populate devices
   refreshDevices();
@@ -35,6 +42,7 @@ OpenSocketCanWidget::OpenSocketCanWidget(QWidget* parent) : AbstractStreamWidget
 
 void OpenSocketCanWidget::refreshDevices() {
   device_edit->clear();
+  if (!QCanBus::instance()->plugins().contains("socketcan")) return;
   for (auto device : QCanBus::instance()->availableDevices(QStringLiteral("socketcan"))) {
     device_edit->addItem(device.name());
   }
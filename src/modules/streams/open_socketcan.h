@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QCheckBox>
 #include <QComboBox>
 
 #include "abstract.h"
@@ -16,5 +17,6 @@ class OpenSocketCanWidget : public AbstractStreamWidget {
   void refreshDevices();
 
   QComboBox* device_edit;
+  QCheckBox* native_check;
   SocketCanStreamConfig config = {};
 };
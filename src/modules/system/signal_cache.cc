@@ -0,0 +1,258 @@
+#include "signal_cache.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "modules/settings/settings.h"
+#include "stream_manager.h"
+
+namespace {
+
+inline void hashMix(size_t& h, auto v) {
+  h ^= std::hash<decltype(v)>{}(v) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+}
+
+// Calls fn(chunk, first, n, done) for each chunk span of events [pos, pos + count), where done counts
+// the events visited before the span
+template <typename Fn>
+void forEachSpan(const MessageEvents& events, size_t pos, size_t count, Fn&& fn) {
+  const size_t last = pos + count;
+  size_t first = 0;
+  for (const auto& chunk : events.chunks()) {
+    const size_t end = first + chunk.size();
+    if (end > pos && first < last) {
+      const size_t lo = std::max(pos, first) - first;
+      const size_t n = std::min(last, end) - first - lo;
+      fn(chunk, lo, n, first + lo - pos);
+    }
+    if (end >= last) break;
+    first = end;
+  }
+}
+
+}  // namespace
+
+SignalCache::Definition::Definition(const dbc::Signal* s)
+    : start_bit(s->start_bit),
+      size(s->size),
+      is_signed(s->is_signed),
+      is_little_endian(s->is_little_endian),
+      factor(s->factor),
+      offset(s->offset),
+      multiplex_value(s->multiplex_value),
+      type(s->type) {}
+
+SignalCache::Key::Key(const MessageId& msg_id, const dbc::Signal* s) : id(msg_id), sig(s) {
+  if (s->multiplexor) multiplexor.emplace(s->multiplexor);
+}
+
+// Only buckets keys; equal hashes still compare every field
+size_t SignalCache::KeyHash::operator()(const Key& k) const {
+  size_t h = std::hash<MessageId>{}(k.id);
+  auto mix = [&h](const Definition& d) {
+    hashMix(h, d.start_bit);
+    hashMix(h, d.size);
+    hashMix(h, d.is_signed);
+    hashMix(h, d.is_little_endian);
+    hashMix(h, d.factor);
+    hashMix(h, d.offset);
+    hashMix(h, d.multiplex_value);
+    hashMix(h, (int)d.type);
+  };
+  mix(k.sig);
+  if (k.multiplexor) mix(*k.multiplexor);
+  return h;
+}
+
+void SignalCache::decode(const dbc::Msg* msg, const std::vector<const dbc::Signal*>& sigs,
+                         const MessageEvents& events, size_t pos, size_t count, const std::vector<double*>& out) {
+  std::vector<double*> span_out(out.size());
+  forEachSpan(events, pos, count, [&](const MessageEvents::Chunk& chunk, size_t lo, size_t n, size_t done) {
+    const uint8_t* sizes = chunk.sizes() ? chunk.sizes() + lo : nullptr;
+    if (msg) {
+      for (size_t k = 0; k < out.size(); ++k) span_out[k] = out[k] + done;
+      msg->parseBatch(sigs, chunk.data(lo), chunk.stride(), sizes, n, span_out.data());
+    } else {
+      for (size_t k = 0; k < sigs.size(); ++k) sigs[k]->parseBatch(chunk.data(lo), chunk.stride(), sizes, n, out[k] + done);
+    }
+  });
+}
+
+SignalCache& SignalCache::instance() {
+  static SignalCache cache;
+  return cache;
+}
+
+SignalCache::SignalCache() : QObject(nullptr) {
+  auto* dbc = GetDBC();
+  connect(dbc, &dbc::Manager::signalUpdated, this, qOverload<const dbc::Signal*>(&SignalCache::invalidate));
+  connect(dbc, &dbc::Manager::signalRemoved, this, qOverload<const dbc::Signal*>(&SignalCache::invalidate));
+  connect(dbc, &dbc::Manager::msgRemoved, this, qOverload<const MessageId&>(&SignalCache::invalidate));
+  connect(dbc, &dbc::Manager::DBCFileChanged, this, &SignalCache::clear);
+}
+
+std::shared_ptr<const DecodedSignal> SignalCache::find(const MessageId& id, const dbc::Signal* sig) {
+  std::lock_guard lk(mutex_);
+  auto it = entries_.find(Key(id, sig));
+  if (it == entries_.end()) return nullptr;
+
+  lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+  return it->second.data;
+}
+
+std::shared_ptr<const DecodedSignal> SignalCache::get(const MessageId& id, const dbc::Signal* sig) {
+  return get(id, {sig}, nullptr).front();
+}
+
+std::vector<std::shared_ptr<const DecodedSignal>> SignalCache::get(const MessageId& id,
+                                                                   const std::vector<const dbc::Signal*>& sigs,
+                                                                   const dbc::Msg* msg) {
+  std::vector<std::shared_ptr<const DecodedSignal>> result(sigs.size());
+  std::vector<const dbc::Signal*> missing;
+  for (size_t k = 0; k < sigs.size(); ++k) {
+    if (!(result[k] = find(id, sigs[k]))) missing.push_back(sigs[k]);
+  }
+  if (missing.empty()) return result;
+
+  // Decode without holding the lock so charts can fill their entries in parallel
+  const auto& events = StreamManager::stream()->events(id);
+  std::vector<std::shared_ptr<DecodedSignal>> decoded(missing.size());
+  std::vector<double*> out(missing.size());
+  for (size_t k = 0; k < missing.size(); ++k) {
+    decoded[k] = std::make_shared<DecodedSignal>();
+    decoded[k]->values.resize(events.size());
+    out[k] = decoded[k]->values.data();
+  }
+  decode(msg, missing, events, 0, events.size(), out);
+
+  std::lock_guard lk(mutex_);
+  for (size_t k = 0, m = 0; k < sigs.size(); ++k) {
+    if (result[k]) continue;
+
+    const Key key(id, sigs[k]);
+    auto [it, inserted] = entries_.try_emplace(key);
+    if (inserted) {
+      lru_.push_front(key);
+      it->second = {decoded[m], sigs[k], lru_.begin()};
+      memory_usage_ += decoded[m]->memoryUsage();
+    }
+    result[k] = it->second.data;
+    ++m;
+  }
+  evict();
+  return result;
+}
+
+void SignalCache::eventsMerged(const EventRangeMap& new_events) {
+  std::lock_guard lk(mutex_);
+  auto* stream = StreamManager::stream();
+
+  // Entries grouped by message, so all signals of a message are extended in one pass
+  std::unordered_map<MessageId, std::vector<Entry*>> merged;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto& entry = it->second;
+    auto range_it = new_events.find(it->first.id);
+    if (range_it == new_events.end()) {
+      ++it;
+      continue;
+    }
+
+    // Entries that fell out of step with the event store are decoded again on next use
+    if (entry.data->values.size() + range_it->second.size() != stream->events(it->first.id).size()) {
+      memory_usage_ -= entry.data->memoryUsage();
+      lru_.erase(entry.lru_pos);
+      it = entries_.erase(it);
+      continue;
+    }
+    merged[it->first.id].push_back(&entry);
+    ++it;
+  }
+
+  std::vector<const dbc::Signal*> sigs;
+  std::vector<double*> out;
+  for (auto& [id, group] : merged) {
+    const auto& range = new_events.at(id);
+    const size_t pos = range.begin().index();
+    const size_t count = range.size();
+    sigs.clear();
+    out.clear();
+    for (Entry* entry : group) {
+      memory_usage_ -= entry->data->memoryUsage();
+      // Copy on write, in case a caller still holds the previous series
+      if (entry->data.use_count() > 1) entry->data = std::make_shared<DecodedSignal>(*entry->data);
+      auto& values = entry->data->values;
+      values.insert(values.begin() + pos, count, 0.0);
+      memory_usage_ += entry->data->memoryUsage();
+      sigs.push_back(entry->sig);
+      out.push_back(values.data() + pos);
+    }
+    decode(GetDBC()->msg(id), sigs, stream->events(id), pos, count, out);
+  }
+  evict();
+}
+
+void SignalCache::invalidate(const dbc::Signal* sig) {
+  std::lock_guard lk(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    // Signals multiplexed by sig change with it
+    if (it->second.sig == sig || it->second.sig->multiplexor == sig) {
+      memory_usage_ -= it->second.data->memoryUsage();
+      lru_.erase(it->second.lru_pos);
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void SignalCache::invalidate(const MessageId& id) {
+  std::lock_guard lk(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->first.id == id) {
+      memory_usage_ -= it->second.data->memoryUsage();
+      lru_.erase(it->second.lru_pos);
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void SignalCache::evict() {
+  // Always keep the most recent entry, even if it alone exceeds the budget
+  const size_t budget = size_t(settings.signal_cache_mb) * 1024 * 1024;
+  for (auto it = lru_.end(); memory_usage_ > budget && it != lru_.begin() && std::prev(it) != lru_.begin();) {
+    --it;
+    if (pins_.contains(it->id)) continue;
+
+    auto entry = entries_.find(*it);
+    memory_usage_ -= entry->second.data->memoryUsage();
+    entries_.erase(entry);
+    it = lru_.erase(it);
+  }
+}
+
+void SignalCache::pin(const MessageId& id) {
+  std::lock_guard lk(mutex_);
+  ++pins_[id];
+}
+
+void SignalCache::unpin(const MessageId& id) {
+  std::lock_guard lk(mutex_);
+  if (auto it = pins_.find(id); it != pins_.end() && --it->second == 0) {
+    pins_.erase(it);
+    evict();
+  }
+}
+
+void SignalCache::clear() {
+  std::lock_guard lk(mutex_);
+  entries_.clear();
+  lru_.clear();
+  memory_usage_ = 0;
+}
+
+size_t SignalCache::memoryUsage() const {
+  std::lock_guard lk(mutex_);
+  return memory_usage_;
+}
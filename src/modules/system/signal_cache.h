@@ -0,0 +1,94 @@
+#pragma once
+
+#include <QObject>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "core/dbc/dbc_manager.h"
+#include "core/streams/abstract_stream.h"
+
+// Values of one signal for every event of its message, in event order.
+// NaN marks events that don't carry the signal (e.g. another multiplexer value).
+struct DecodedSignal {
+  std::vector<double> values;
+  inline size_t memoryUsage() const { return values.capacity() * sizeof(double); }
+};
+
+/**
+ * @brief Process-wide cache of decoded signal time series, shared by charts, sparklines,
+ * the history view and export. Entries are keyed by message and signal definition,
+ * kept in step with the stream as events are merged, dropped when the signal changes,
+ * and evicted least-recently-used once settings.signal_cache_mb is exceeded, except for pinned messages.
+ */
+class SignalCache : public QObject {
+  Q_OBJECT
+
+ public:
+  static SignalCache& instance();
+
+  // Decodes on first use. Safe to call from worker threads.
+  // The result must not be held across calls to eventsMerged().
+  std::shared_ptr<const DecodedSignal> get(const MessageId& id, const dbc::Signal* sig);
+  // Same as get() for several signals of msg, whose missing entries are decoded together in one
+  // pass over the events. msg may be null when the signals aren't known to share a message.
+  std::vector<std::shared_ptr<const DecodedSignal>> get(const MessageId& id, const std::vector<const dbc::Signal*>& sigs,
+                                                        const dbc::Msg* msg);
+  // Same as get(), but returns nullptr instead of decoding
+  std::shared_ptr<const DecodedSignal> find(const MessageId& id, const dbc::Signal* sig);
+  // Decodes newly merged events into the existing entries. Called by StreamManager before it
+  // forwards eventsMerged, so consumers always see entries that match the event store.
+  void eventsMerged(const EventRangeMap& new_events);
+  // Exempts the entries of a message from eviction while it is on screen, so views that look values
+  // up per cell never decode again under memory pressure. Pins are counted.
+  void pin(const MessageId& id);
+  void unpin(const MessageId& id);
+  void clear();
+  size_t memoryUsage() const;
+
+  // Decodes events [pos, pos + count) of sigs[k] into out[k] without caching, chunk by chunk so each
+  // run goes through the batch kernels. Signals of one message share a single pass when msg is known.
+  static void decode(const dbc::Msg* msg, const std::vector<const dbc::Signal*>& sigs, const MessageEvents& events,
+                     size_t pos, size_t count, const std::vector<double*>& out);
+
+ private:
+  SignalCache();
+  void invalidate(const dbc::Signal* sig);
+  void invalidate(const MessageId& id);
+  void evict();
+
+  // The fields that affect the decoded value
+  struct Definition {
+    explicit Definition(const dbc::Signal* s);
+    int start_bit, size;
+    bool is_signed, is_little_endian;
+    double factor, offset;
+    int multiplex_value;
+    dbc::Signal::Type type;
+    bool operator==(const Definition&) const = default;
+  };
+  struct Key {
+    Key(const MessageId& msg_id, const dbc::Signal* s);
+    MessageId id;
+    Definition sig;
+    std::optional<Definition> multiplexor;
+    bool operator==(const Key&) const = default;
+  };
+  struct KeyHash {
+    size_t operator()(const Key& k) const;
+  };
+  struct Entry {
+    std::shared_ptr<DecodedSignal> data;
+    const dbc::Signal* sig;  // Used to extend the entry; any signal with this definition will do
+    std::list<Key>::iterator lru_pos;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<Key, Entry, KeyHash> entries_;
+  std::list<Key> lru_;  // Most recently used first
+  std::unordered_map<MessageId, int> pins_;
+  size_t memory_usage_ = 0;
+};
@@ -3,6 +3,7 @@
 #include <QDebug>
 #include <QProgressDialog>
 
+#include "signal_cache.h"
 #include "system_relay.h"
 
 StreamManager::StreamManager() : QObject(nullptr) { setStream(new DummyStream(this)); }
@@ -14,9 +15,13 @@ void StreamManager::setStream(AbstractStream* new_stream, const QString& dbc_fil
     stream_->deleteLater();
     stream_ = nullptr;
   }
+  SignalCache::instance().clear();
   stream_ = new_stream ? new_stream : new DummyStream(this);
   stream_->setParent(this);
-  connect(stream_, &AbstractStream::eventsMerged, this, &StreamManager::eventsMerged);
+  connect(stream_, &AbstractStream::eventsMerged, this, [this](const EventRangeMap& new_events) {
+    SignalCache::instance().eventsMerged(new_events);
+    emit eventsMerged(new_events);
+  });
   connect(stream_, &AbstractStream::paused, this, &StreamManager::paused);
   connect(stream_, &AbstractStream::resume, this, &StreamManager::resume);
   connect(stream_, &AbstractStream::seeking, this, &StreamManager::seeking);
@@ -45,7 +45,7 @@ class StreamManager : public QObject {
   void seekedTo(double sec);
 
   void timeRangeChanged(const std::optional<std::pair<double, double>>& range);
-  void eventsMerged(const MessageEventsMap& events_map);
+  void eventsMerged(const EventRangeMap& new_events);
   void snapshotsUpdated(const std::set<MessageId>* ids, bool needs_rebuild);
   void sourcesUpdated(const SourceSet& s);
   void qLogLoaded(std::shared_ptr<LogReader> qlog);
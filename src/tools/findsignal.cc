@@ -5,14 +5,82 @@
 #include <QHeaderView>
 #include <QMenu>
 #include <QTimer>
+#include <QThread>
 #include <QVBoxLayout>
 #include <QtConcurrent>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <deque>
 
 #include "modules/system/stream_manager.h"
 #include "widgets/validators.h"
 
 // FindSignalModel
 
+namespace {
+
+constexpr size_t kCandidatesPerTask = 1024;
+constexpr size_t kFramesPerStep = 1 << 16;
+
+// Candidates of one message still waiting for a match, scanned a bounded number of frames per step
+struct Task {
+  MessageId id;
+  std::vector<uint32_t> pending;  // Indices into the previous step
+  uint64_t cursor = 0;            // Frames after this time are left to scan
+  uint64_t frames_left = 0;       // For progress
+  uint64_t scanned = 0;
+  bool done = false;
+  std::vector<FindSignalModel::Candidate> found;
+};
+
+// Where a candidate's bits sit in one 8-byte window of the payload, worked out once per job
+struct Extractor {
+  uint8_t window = 0;    // Index into the task's window starts
+  uint8_t end_byte = 0;  // Frames shorter than this are decoded by the signal
+  int shift = 0;
+  uint64_t mask = 0;
+  uint64_t sign_bit = 0;  // 0 for unsigned searches
+  bool fast = false;      // False when the bits span more than one window
+};
+
+Extractor makeExtractor(const dbc::Signal& s, std::vector<uint8_t>& window_starts) {
+  const int msb_byte = s.msb / 8;
+  const int lsb_byte = s.lsb / 8;
+  const int first_byte = std::min(msb_byte, lsb_byte);
+  const int last_byte = std::max(msb_byte, lsb_byte);
+  if (s.msb < 0 || s.lsb < 0 || last_byte - first_byte >= 8 || last_byte >= MAX_CAN_LEN) return {};
+
+  // Windows end at the candidate's last byte, so every candidate of a classic frame shares the one at 0
+  const uint8_t start = std::max(0, last_byte - 7);
+  auto it = std::ranges::find(window_starts, start);
+  if (it == window_starts.end()) it = window_starts.insert(window_starts.end(), start);
+
+  return {
+      .window = uint8_t(it - window_starts.begin()),
+      .end_byte = uint8_t(last_byte + 1),
+      // Little endian: bit b of the payload is bit b - 8 * start of the window. Big endian: the window
+      // is byte swapped, so its byte k is the (7 - k)-th most significant.
+      .shift = s.is_little_endian ? s.lsb - 8 * start : 56 - 8 * (lsb_byte - start) + (s.lsb & 7),
+      .mask = s.size == 64 ? ~0ULL : (1ULL << s.size) - 1,
+      .sign_bit = s.is_signed ? 1ULL << (s.size - 1) : 0,
+      .fast = true,
+  };
+}
+
+}  // namespace
+
+struct FindSignalModel::Job {
+  std::function<bool(double)> cmp;
+  const std::vector<Candidate>* prev;
+  std::deque<Task> queue;
+  uint64_t total_frames = 0;
+  uint64_t scanned_frames = 0;
+};
+
+FindSignalModel::FindSignalModel(QObject* parent) : QAbstractTableModel(parent) {}
+FindSignalModel::~FindSignalModel() = default;
+
 QVariant FindSignalModel::headerData(int section, Qt::Orientation orientation, int role) const {
   static QString titles[] = {"Id", "Start Bit, size", "(time, value)"};
   if (role != Qt::DisplayRole) return {};
@@ -24,55 +92,198 @@ QVariant FindSignalModel::data(const QModelIndex& index, int role) const {
     const auto& s = filtered_signals[index.row()];
     switch (index.column()) {
       case 0: return s.id.toString();
-      case 1: return QString("%1, %2").arg(s.sig.start_bit).arg(s.sig.size);
-      case 2: return s.values.join(" ");
+      case 1: return QString("%1, %2").arg(s.start_bit).arg(s.size);
+      case 2: return matchHistory(s);
     }
   }
   return {};
 }
 
+QString FindSignalModel::matchHistory(const Candidate& c) const {
+  // Follow the candidate back through the steps; step 0 is the initial set, which has no match
+  auto list = [this](size_t step) -> const std::vector<Candidate>& {
+    return step == 0 ? initial_signals : histories[step - 1];
+  };
+  QStringList values;
+  const Candidate* cur = &c;
+  for (size_t step = histories.size() + (isSearching() ? 1 : 0); step > 0; --step) {
+    values.prepend(QString("(%1, %2)").arg(StreamManager::stream()->toSeconds(cur->mono_ns), 0, 'f', 3).arg(cur->value));
+    cur = &list(step - 1)[cur->parent];
+  }
+  return values.join(" ");
+}
+
+dbc::Signal FindSignalModel::makeSignal(const Candidate& c) const {
+  dbc::Signal sig{};
+  sig.is_little_endian = properties.is_little_endian;
+  sig.is_signed = properties.is_signed;
+  sig.factor = properties.factor;
+  sig.offset = properties.offset;
+  sig.start_bit = c.start_bit;
+  sig.size = c.size;
+  updateMsbLsb(sig);
+  return sig;
+}
+
 void FindSignalModel::search(std::function<bool(double)> cmp) {
-  beginResetModel();
+  if (job_) return;
 
-  std::mutex lock;
-  const auto prev_sigs = !histories.isEmpty() ? histories.back() : initial_signals;
+  beginResetModel();
   filtered_signals.clear();
-  filtered_signals.reserve(prev_sigs.size());
-  QtConcurrent::blockingMap(prev_sigs, [&](auto& s) {
-    const auto& events = StreamManager::stream()->events(s.id);
-    auto first = std::ranges::upper_bound(events, s.mono_ns, {}, &CanEvent::mono_ns);
-    auto last = events.cend();
-    if (last_time < std::numeric_limits<uint64_t>::max()) {
-      last = std::ranges::upper_bound(events, last_time, {}, &CanEvent::mono_ns);
+  job_ = std::make_unique<Job>();
+  job_->cmp = std::move(cmp);
+  job_->prev = histories.empty() ? &initial_signals : &histories.back();
+
+  // Split the candidates, which are grouped by message, into tasks
+  const auto& prev = *job_->prev;
+  auto* can = StreamManager::stream();
+  for (uint32_t i = 0; i < prev.size(); ++i) {
+    auto& queue = job_->queue;
+    if (queue.empty() || queue.back().id != prev[i].id || queue.back().pending.size() >= kCandidatesPerTask) {
+      queue.push_back({.id = prev[i].id, .cursor = prev[i].mono_ns});
     }
+    queue.back().pending.push_back(i);
+    queue.back().cursor = std::min(queue.back().cursor, prev[i].mono_ns);
+  }
+  for (auto& t : job_->queue) {
+    const auto& events = can->events(t.id);
+    t.frames_left = events.upperBound(last_time) - std::min(events.upperBound(t.cursor), events.upperBound(last_time));
+    job_->total_frames += t.frames_left;
+  }
+  endResetModel();
+
+  QTimer::singleShot(0, this, &FindSignalModel::step);
+}
+
+void FindSignalModel::step() {
+  if (!job_) return;
+
+  // Run a few tasks per worker thread, then return to the event loop
+  const size_t n = std::min<size_t>(job_->queue.size(), std::max(1, QThread::idealThreadCount()) * 2);
+  std::vector<Task> batch(std::make_move_iterator(job_->queue.begin()), std::make_move_iterator(job_->queue.begin() + n));
+  job_->queue.erase(job_->queue.begin(), job_->queue.begin() + n);
 
-    auto it =
-        std::ranges::find_if(first, last, cmp, [&](const CanEvent* e) { return s.sig.toPhysical(e->dat, e->size); });
-    if (it != last) {
-      auto values = s.values;
-      values += QString("(%1, %2)")
-                    .arg(StreamManager::stream()->toSeconds((*it)->mono_ns), 0, 'f', 3)
-                    .arg(s.sig.toPhysical((*it)->dat, (*it)->size));
-      std::lock_guard lk(lock);
-      filtered_signals.push_back({.id = s.id, .mono_ns = (*it)->mono_ns, .sig = s.sig, .values = values});
+  const auto& prev = *job_->prev;
+  const auto& cmp = job_->cmp;
+  const uint64_t end_time = last_time;
+  QtConcurrent::blockingMap(batch, [&](Task& t) {
+    const auto& events = StreamManager::stream()->events(t.id);
+    auto it = events.begin() + events.upperBound(t.cursor);
+    auto last = events.begin() + events.upperBound(end_time);
+
+    // Candidates share the search's byte order, sign and scaling, so each one reduces to a window,
+    // shift and mask. Every window of a frame is loaded once for all candidates inside it.
+    std::vector<uint8_t> window_starts;
+    std::vector<Extractor> extractors;
+    extractors.reserve(t.pending.size());
+    for (uint32_t i : t.pending) {
+      extractors.push_back(makeExtractor(makeSignal(prev[i]), window_starts));
+    }
+    const bool little_endian = properties.is_little_endian;
+    const double factor = properties.factor;
+    const double offset = properties.offset;
+
+    std::array<uint8_t, MAX_CAN_LEN> payload = {};
+    std::vector<uint64_t> words(window_starts.size());
+
+    // One pass over the frames extracts every pending bit range; matched ones drop out
+    uint64_t scanned = 0;
+    for (; it != last && !t.pending.empty(); ++it, ++scanned) {
+      const CanEvent e = *it;
+      // Stop between timestamps, so the next step can resume after the cursor
+      if (scanned >= kFramesPerStep && e.mono_ns != t.cursor) break;
+      t.cursor = e.mono_ns;
+
+      std::memcpy(payload.data(), e.dat, std::min<size_t>(e.size, MAX_CAN_LEN));
+      for (size_t w = 0; w < window_starts.size(); ++w) {
+        uint64_t word;
+        std::memcpy(&word, payload.data() + window_starts[w], 8);
+        if (little_endian != (std::endian::native == std::endian::little)) word = __builtin_bswap64(word);
+        words[w] = word;
+      }
+
+      for (size_t k = 0; k < t.pending.size();) {
+        const auto& c = prev[t.pending[k]];
+        if (e.mono_ns > c.mono_ns) {
+          const auto& x = extractors[k];
+          double v;
+          if (x.fast && x.end_byte <= e.size) {
+            const uint64_t val = (words[x.window] >> x.shift) & x.mask;
+            v = (val & x.sign_bit) ? static_cast<int64_t>(val | ~x.mask) * factor + offset : val * factor + offset;
+          } else {
+            v = makeSignal(c).toPhysical(e.dat, e.size);
+          }
+          if (cmp(v)) {
+            t.found.push_back({.id = c.id, .start_bit = c.start_bit, .size = c.size, .parent = t.pending[k],
+                               .mono_ns = e.mono_ns, .value = v});
+            t.pending[k] = t.pending.back();
+            t.pending.pop_back();
+            extractors[k] = extractors.back();
+            extractors.pop_back();
+            continue;
+          }
+        }
+        ++k;
+      }
     }
+    t.scanned = scanned;
+    t.done = it == last || t.pending.empty();
   });
-  histories.push_back(filtered_signals);
 
+  size_t found = 0;
+  for (const auto& t : batch) found += t.found.size();
+  const int rows = rowCount();
+  const int new_rows = std::min<int>(filtered_signals.size() + found, 300);
+  if (new_rows > rows) beginInsertRows({}, rows, new_rows - 1);
+  for (auto& t : batch) {
+    filtered_signals.insert(filtered_signals.end(), t.found.begin(), t.found.end());
+    t.found.clear();
+    const uint64_t scanned = std::min(t.scanned, t.frames_left);
+    t.frames_left -= scanned;
+    job_->scanned_frames += t.done ? scanned + t.frames_left : scanned;
+    if (!t.done) job_->queue.push_back(std::move(t));
+  }
+  if (new_rows > rows) endInsertRows();
+
+  if (job_->queue.empty()) {
+    finish(false);
+  } else {
+    emit progress(job_->total_frames ? job_->scanned_frames * 100 / job_->total_frames : 100);
+    QTimer::singleShot(0, this, &FindSignalModel::step);
+  }
+}
+
+void FindSignalModel::finish(bool canceled) {
+  beginResetModel();
+  if (canceled) {
+    filtered_signals = histories.empty() ? std::vector<Candidate>{} : histories.back();
+  } else {
+    // Keep the candidates grouped by message, in the order of the previous step
+    std::ranges::sort(filtered_signals, {}, &Candidate::parent);
+    histories.push_back(filtered_signals);
+  }
+  job_.reset();
   endResetModel();
+  emit searchFinished();
+}
+
+void FindSignalModel::cancel() {
+  if (job_) finish(true);
 }
 
 void FindSignalModel::undo() {
-  if (!histories.isEmpty()) {
+  cancel();
+  if (!histories.empty()) {
     beginResetModel();
     histories.pop_back();
     filtered_signals.clear();
-    if (!histories.isEmpty()) filtered_signals = histories.back();
+    if (!histories.empty()) filtered_signals = histories.back();
     endResetModel();
   }
 }
 
 void FindSignalModel::reset() {
+  cancel();
   beginResetModel();
   histories.clear();
   filtered_signals.clear();
@@ -166,6 +377,7 @@ FindSignalDlg::FindSignalDlg(QWidget* parent) : QDialog(parent, Qt::WindowFlags(
   connect(search_btn, &QPushButton::clicked, this, &FindSignalDlg::search);
   connect(undo_btn, &QPushButton::clicked, model, &FindSignalModel::undo);
   connect(model, &QAbstractItemModel::modelReset, this, &FindSignalDlg::modelReset);
+  connect(model, &FindSignalModel::progress, this, &FindSignalDlg::searchProgress);
   connect(reset_btn, &QPushButton::clicked, model, &FindSignalModel::reset);
   connect(view, &QTableView::customContextMenuRequested, this, &FindSignalDlg::customMenuRequested);
   connect(view, &QTableView::doubleClicked, [this](const QModelIndex& index) {
@@ -178,7 +390,11 @@ FindSignalDlg::FindSignalDlg(QWidget* parent) : QDialog(parent, Qt::WindowFlags(
 }
 
 void FindSignalDlg::search() {
-  if (model->histories.isEmpty()) {
+  if (model->isSearching()) {
+    model->cancel();
+    return;
+  }
+  if (model->histories.empty()) {
     setInitialSignals();
   }
   auto v1 = value1->text().toDouble();
@@ -193,12 +409,7 @@ void FindSignalDlg::search() {
     case 5: cmp = [v1](double v) { return v <= v1; }; break;
     case 6: cmp = [v1, v2](double v) { return v >= v1 && v <= v2; }; break;
   }
-  properties_group->setEnabled(false);
-  message_group->setEnabled(false);
-  search_btn->setEnabled(false);
-  stats_label->setVisible(false);
-  search_btn->setText("Finding ....");
-  QTimer::singleShot(0, this, [this, cmp]() { model->search(cmp); });
+  model->search(cmp);
 }
 
 void FindSignalDlg::setInitialSignals() {
@@ -214,11 +425,12 @@ void FindSignalDlg::setInitialSignals() {
     if (!addr.isEmpty()) addresses.insert(addr.toULong(nullptr, 16));
   }
 
-  dbc::Signal sig{};
-  sig.is_little_endian = litter_endian->isChecked();
-  sig.is_signed = is_signed->isChecked();
-  sig.factor = factor_edit->text().toDouble();
-  sig.offset = offset_edit->text().toDouble();
+  model->properties = {
+      .is_little_endian = litter_endian->isChecked(),
+      .is_signed = is_signed->isChecked(),
+      .factor = factor_edit->text().toDouble(),
+      .offset = offset_edit->text().toDouble(),
+  };
 
   auto* can = StreamManager::stream();
   double first_time_val = first_time_edit->text().toDouble();
@@ -234,17 +446,12 @@ void FindSignalDlg::setInitialSignals() {
   for (const auto& [id, m] : can->snapshots()) {
     if ((buses.isEmpty() || buses.contains(id.source)) && (addresses.isEmpty() || addresses.contains(id.address))) {
       const auto& events = can->events(id);
-      auto e = std::ranges::lower_bound(events, first_time, {}, &CanEvent::mono_ns);
-      if (e != events.cend()) {
+      if (events.lowerBound(first_time) < events.size()) {
         const int total_size = m->size * 8;
         for (int size = min_size->value(); size <= max_size->value(); ++size) {
           for (int start = 0; start <= total_size - size; ++start) {
-            FindSignalModel::SearchSignal s{.id = id, .mono_ns = first_time, .sig = sig};
-            s.sig.start_bit = start;
-            s.sig.size = size;
-            updateMsbLsb(s.sig);
-            s.value = s.sig.toPhysical((*e)->dat, (*e)->size);
-            model->initial_signals.push_back(s);
+            model->initial_signals.push_back(
+                {.id = id, .start_bit = (uint16_t)start, .size = (uint8_t)size, .mono_ns = first_time});
           }
         }
       }
@@ -253,24 +460,40 @@ void FindSignalDlg::setInitialSignals() {
 }
 
 void FindSignalDlg::modelReset() {
-  properties_group->setEnabled(model->histories.isEmpty());
-  message_group->setEnabled(model->histories.isEmpty());
-  search_btn->setText(model->histories.isEmpty() ? tr("Find") : tr("Find Next"));
-  reset_btn->setEnabled(!model->histories.isEmpty());
+  if (model->isSearching()) {
+    properties_group->setEnabled(false);
+    message_group->setEnabled(false);
+    reset_btn->setEnabled(false);
+    undo_btn->setEnabled(false);
+    search_btn->setEnabled(true);
+    search_btn->setText(tr("Cancel"));
+    searchProgress(0);
+    return;
+  }
+
+  properties_group->setEnabled(model->histories.empty());
+  message_group->setEnabled(model->histories.empty());
+  search_btn->setText(model->histories.empty() ? tr("Find") : tr("Find Next"));
+  reset_btn->setEnabled(!model->histories.empty());
   undo_btn->setEnabled(model->histories.size() > 1);
-  search_btn->setEnabled(model->rowCount() > 0 || model->histories.isEmpty());
+  search_btn->setEnabled(model->rowCount() > 0 || model->histories.empty());
   stats_label->setVisible(true);
   stats_label->setText(tr("%1 matches. right click on an item to create signal. double click to open message")
                            .arg(model->filtered_signals.size()));
 }
 
+void FindSignalDlg::searchProgress(int percent) {
+  stats_label->setVisible(true);
+  stats_label->setText(tr("Finding... %1%, %2 matches so far").arg(percent).arg(model->filtered_signals.size()));
+}
+
 void FindSignalDlg::customMenuRequested(const QPoint& pos) {
   if (auto index = view->indexAt(pos); index.isValid()) {
     QMenu menu(this);
     menu.addAction(tr("Create Signal"));
     if (menu.exec(view->mapToGlobal(pos))) {
       auto& s = model->filtered_signals[index.row()];
-      UndoStack::push(new AddSigCommand(s.id, s.sig));
+      UndoStack::push(new AddSigCommand(s.id, model->makeSignal(s)));
       emit openMessage(s.id);
     }
   }
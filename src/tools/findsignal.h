@@ -12,35 +12,67 @@
 #include <QTableView>
 #include <algorithm>
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include "core/commands/commands.h"
 #include "modules/settings/settings.h"
 
 class FindSignalModel : public QAbstractTableModel {
+  Q_OBJECT
+
  public:
-  struct SearchSignal {
+  // A candidate bit range and where it last matched. Byte order, signedness, factor and offset
+  // are shared by the whole search.
+  struct Candidate {
     MessageId id = {};
-    uint64_t mono_ns = 0;
-    dbc::Signal sig = {};
+    uint16_t start_bit = 0;
+    uint8_t size = 0;
+    uint32_t parent = 0;  // Index of this candidate in the previous step
+    uint64_t mono_ns = 0;  // Time of the last match, or where the search starts
     double value = 0.;
-    QStringList values;
   };
 
-  FindSignalModel(QObject* parent) : QAbstractTableModel(parent) {}
+  struct Properties {
+    bool is_little_endian = true;
+    bool is_signed = false;
+    double factor = 1.0;
+    double offset = 0.;
+  };
+
+  FindSignalModel(QObject* parent);
+  ~FindSignalModel() override;
   QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
   QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
   int columnCount(const QModelIndex& parent = QModelIndex()) const override { return 3; }
   int rowCount(const QModelIndex& parent = QModelIndex()) const override {
     return std::min<int>((int)(filtered_signals.size()), 300);
   }
+  // Starts the next step in the background. Matches are added to the table as they are found.
   void search(std::function<bool(double)> cmp);
+  void cancel();
+  inline bool isSearching() const { return job_ != nullptr; }
   void reset();
   void undo();
+  dbc::Signal makeSignal(const Candidate& c) const;
 
-  QList<SearchSignal> filtered_signals;
-  QList<SearchSignal> initial_signals;
-  QList<QList<SearchSignal>> histories;
+  Properties properties;
+  std::vector<Candidate> filtered_signals;
+  std::vector<Candidate> initial_signals;
+  std::vector<std::vector<Candidate>> histories;
   uint64_t last_time = std::numeric_limits<uint64_t>::max();
+
+ signals:
+  void progress(int percent);
+  void searchFinished();
+
+ private:
+  struct Job;
+  void step();
+  void finish(bool canceled);
+  QString matchHistory(const Candidate& c) const;
+
+  std::unique_ptr<Job> job_;
 };
 
 class FindSignalDlg : public QDialog {
@@ -54,6 +86,7 @@ class FindSignalDlg : public QDialog {
  private:
   void search();
   void modelReset();
+  void searchProgress(int percent);
   void setInitialSignals();
   void customMenuRequested(const QPoint& pos);
 
@@ -7,7 +7,11 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QRadioButton>
+#include <QtConcurrent>
 #include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
 
 #include "core/dbc/dbc_manager.h"
 #include "core/streams/abstract_stream.h"
@@ -60,6 +64,10 @@ FindSimilarBitsDlg::FindSimilarBitsDlg(QWidget* parent) : QDialog(parent, Qt::Wi
   equal_combo = new QComboBox(this);
   equal_combo->addItems({"Yes", "No"});
   find_layout->addWidget(equal_combo);
+  find_layout->addWidget(new QLabel(tr("Rank by")));
+  rank_combo = new QComboBox(this);
+  rank_combo->addItems({tr("Mismatches"), tr("Correlation")});
+  find_layout->addWidget(rank_combo);
   min_msgs = new QLineEdit(this);
   min_msgs->setValidator(new QIntValidator(this));
   min_msgs->setText("100");
@@ -84,6 +92,7 @@ FindSimilarBitsDlg::FindSimilarBitsDlg(QWidget* parent) : QDialog(parent, Qt::Wi
   main_layout->addWidget(table);
 
   setMinimumSize({700, 500});
+  connect(&StreamManager::instance(), &StreamManager::streamChanged, this, [this]() { planes_.clear(); });
   connect(search_btn, &QPushButton::clicked, this, &FindSimilarBitsDlg::find);
   connect(table, &QTableWidget::doubleClicked, [this](const QModelIndex& index) {
     if (index.isValid()) {
@@ -100,10 +109,12 @@ void FindSimilarBitsDlg::find() {
   uint32_t selected_address = msg_cb->currentData().toUInt();
   auto msg_mismatched =
       calcBits(src_bus_combo->currentText().toUInt(), selected_address, byte_idx_sb->value(), bit_idx_sb->value(),
-               find_bus_combo->currentText().toUInt(), equal_combo->currentIndex() == 0, min_msgs->text().toInt());
+               find_bus_combo->currentText().toUInt(), equal_combo->currentIndex() == 0, min_msgs->text().toInt(),
+               rank_combo->currentIndex() == 1);
   table->setRowCount(msg_mismatched.size());
-  table->setColumnCount(6);
-  table->setHorizontalHeaderLabels({"address", "byte idx", "bit idx", "mismatches", "total msgs", "% mismatched"});
+  table->setColumnCount(7);
+  table->setHorizontalHeaderLabels(
+      {"address", "byte idx", "bit idx", "mismatches", "total msgs", "% mismatched", "correlation"});
   for (int i = 0; i < msg_mismatched.size(); ++i) {
     auto& m = msg_mismatched[i];
     table->setItem(i, 0, new QTableWidgetItem(QString("%1").arg(m.address, 1, 16)));
@@ -112,52 +123,160 @@ void FindSimilarBitsDlg::find() {
     table->setItem(i, 3, new QTableWidgetItem(QString::number(m.mismatches)));
     table->setItem(i, 4, new QTableWidgetItem(QString::number(m.total)));
     table->setItem(i, 5, new QTableWidgetItem(QString::number(m.perc, 'f', 2)));
+    table->setItem(i, 6, new QTableWidgetItem(QString::number(m.correlation, 'f', 3)));
   }
   search_btn->setEnabled(true);
 }
 
+FindSimilarBitsDlg::BitPlanes FindSimilarBitsDlg::buildPlanes(const MessageEvents& events) {
+  BitPlanes p;
+  p.frames = events.size();
+  size_t max_size = 0;
+  bool uniform = true;
+  for (const auto& chunk : events.chunks()) {
+    uniform = uniform && !chunk.sizes() && (max_size == 0 || chunk.stride() == max_size);
+    max_size = std::max<size_t>(max_size, chunk.stride());
+  }
+
+  const size_t words = (p.frames + 63) / 64;
+  p.bits.assign(max_size * 8, std::vector<uint64_t>(words));
+  if (!uniform) p.valid.assign(max_size, std::vector<uint64_t>(words));
+
+  // Bytes of 8 consecutive frames are gathered into one word per byte position, then each bit is
+  // pulled out of all 8 at once with a multiply
+  std::vector<uint64_t> group(max_size);
+  auto flush = [&](size_t frame) {
+    const size_t w = frame / 64, shift = (frame / 8 % 8) * 8;
+    for (size_t b = 0; b < max_size; ++b) {
+      for (int j = 0; j < 8; ++j) {
+        const uint64_t column = ((group[b] >> (7 - j)) & 0x0101010101010101ULL) * 0x0102040810204080ULL >> 56;
+        p.bits[b * 8 + j][w] |= column << shift;
+      }
+      group[b] = 0;
+    }
+  };
+
+  size_t i = 0;
+  for (const auto& chunk : events.chunks()) {
+    for (size_t k = 0; k < chunk.size(); ++k, ++i) {
+      const uint8_t* dat = chunk.data(k);
+      const size_t size = chunk.dataSize(k);
+      for (size_t b = 0; b < size; ++b) group[b] |= uint64_t(dat[b]) << (i % 8 * 8);
+      if (!uniform) {
+        for (size_t b = 0; b < size; ++b) p.valid[b][i / 64] |= 1ULL << (i % 64);
+      }
+      if (i % 8 == 7) flush(i);
+    }
+  }
+  if (i % 8 != 0) flush(i - 1);
+  return p;
+}
+
+void FindSimilarBitsDlg::updatePlanes(const std::vector<MessageId>& ids) {
+  auto* can = StreamManager::stream();
+  std::vector<MessageId> stale;
+  for (const auto& id : ids) {
+    auto it = planes_.find(id);
+    if (it == planes_.end() || it->second.frames != can->events(id).size()) stale.push_back(id);
+  }
+  const auto built = QtConcurrent::blockingMapped<std::vector<BitPlanes>>(
+      stale, [can](const MessageId& id) { return buildPlanes(can->events(id)); });
+  for (size_t i = 0; i < stale.size(); ++i) planes_[stale[i]] = std::move(built[i]);
+}
+
 QList<FindSimilarBitsDlg::mismatched_struct> FindSimilarBitsDlg::calcBits(uint8_t bus, uint32_t selected_address,
                                                                           int byte_idx, int bit_idx, uint8_t find_bus,
-                                                                          bool equal, int min_msgs_cnt) {
-  QHash<uint32_t, QVector<uint32_t>> mismatches;
-  QHash<uint32_t, uint32_t> msg_count;
-  const auto& events = StreamManager::stream()->allEvents();
-  int bit_to_find = -1;
-  for (const CanEvent* e : events) {
-    if (e->src == bus) {
-      if (e->address == selected_address && e->size > byte_idx) {
-        bit_to_find = ((e->dat[byte_idx] >> (7 - bit_idx)) & 1) != 0;
+                                                                          bool equal, int min_msgs_cnt,
+                                                                          bool by_correlation) {
+  auto* can = StreamManager::stream();
+  const MessageId ref_id(bus, selected_address);
+  std::vector<MessageId> targets;
+  for (const auto& [id, events] : can->eventsMap()) {
+    if (id.source == find_bus && !events.empty()) targets.push_back(id);
+  }
+  std::vector<MessageId> ids = targets;
+  ids.push_back(ref_id);
+  updatePlanes(ids);
+
+  // Reference frames that carry the bit, with its value, in time order
+  const auto& ref_events = can->events(ref_id);
+  const auto& ref = planes_[ref_id];
+  std::vector<uint64_t> ref_ts;
+  std::vector<bool> ref_bit;
+  if (byte_idx * 8 + bit_idx < (int)ref.bits.size()) {
+    const auto& plane = ref.bits[byte_idx * 8 + bit_idx];
+    size_t i = 0;
+    for (const auto& chunk : ref_events.chunks()) {
+      for (size_t k = 0; k < chunk.size(); ++k, ++i) {
+        if (!ref.valid.empty() && !(ref.valid[byte_idx][i / 64] >> (i % 64) & 1)) continue;
+        ref_ts.push_back(chunk.monoNs(k));
+        ref_bit.push_back(plane[i / 64] >> (i % 64) & 1);
       }
     }
-    if (e->src == find_bus) {
-      ++msg_count[e->address];
-      if (bit_to_find == -1) continue;
+  }
 
-      auto& mismatched = mismatches[e->address];
-      if (mismatched.size() < e->size * 8) {
-        mismatched.resize(e->size * 8);
-      }
-      for (int i = 0; i < e->size; ++i) {
-        for (int j = 0; j < 8; ++j) {
-          int bit = ((e->dat[i] >> (7 - j)) & 1) != 0;
-          mismatched[i * 8 + j] += equal ? (bit != bit_to_find) : (bit == bit_to_find);
+  auto compare = [&](const MessageId& id) {
+    std::vector<mismatched_struct> result;
+    const auto& events = can->events(id);
+    const auto& p = planes_.at(id);
+    const uint32_t cnt = p.frames;
+    if ((int64_t)cnt <= min_msgs_cnt) return result;
+
+    // Sample the reference bit at each frame: the latest reference frame visited before it, in the
+    // order forEachEvent() visits them (ties go to the lower message id)
+    const size_t words = (p.frames + 63) / 64;
+    std::vector<uint64_t> ref_value(words), known(words);
+    size_t r = 0, i = 0;
+    for (const auto& chunk : events.chunks()) {
+      for (size_t k = 0; k < chunk.size(); ++k, ++i) {
+        const uint64_t ts = chunk.monoNs(k);
+        while (r < ref_ts.size() && (ref_ts[r] < ts || (ref_ts[r] == ts && !(ref_id > id)))) ++r;
+        if (r > 0) {
+          known[i / 64] |= 1ULL << (i % 64);
+          ref_value[i / 64] |= uint64_t(ref_bit[r - 1]) << (i % 64);
         }
       }
     }
-  }
 
-  QList<mismatched_struct> result;
-  result.reserve(mismatches.size());
-  for (auto it = mismatches.begin(); it != mismatches.end(); ++it) {
-    if (auto cnt = msg_count[it.key()]; cnt > min_msgs_cnt) {
-      auto& mismatched = it.value();
-      for (int i = 0; i < mismatched.size(); ++i) {
-        if (float perc = (mismatched[i] / (double)cnt) * 100; perc < 50) {
-          result.push_back({it.key(), (uint32_t)i / 8, (uint32_t)i % 8, mismatched[i], cnt, perc});
+    for (size_t b = 0; b < p.bits.size() / 8; ++b) {
+      auto mask = [&](size_t w) { return p.valid.empty() ? known[w] : known[w] & p.valid[b][w]; };
+      // Bytes no frame carried after the reference appeared are left out
+      uint64_t n = 0;
+      for (size_t w = 0; w < words; ++w) n += std::popcount(mask(w));
+      if (n == 0) continue;
+
+      uint64_t ref_ones = 0;
+      for (size_t w = 0; w < words; ++w) ref_ones += std::popcount(ref_value[w] & mask(w));
+      for (size_t j = 0; j < 8; ++j) {
+        const auto& plane = p.bits[b * 8 + j];
+        uint64_t diff = 0, ones = 0, both = 0;
+        for (size_t w = 0; w < words; ++w) {
+          const uint64_t m = mask(w);
+          diff += std::popcount((plane[w] ^ ref_value[w]) & m);
+          ones += std::popcount(plane[w] & m);
+          both += std::popcount(plane[w] & ref_value[w] & m);
+        }
+        const uint32_t mismatches = equal ? diff : n - diff;
+        // Phi coefficient between the two bits; 0 when either is constant
+        const double denom = std::sqrt(double(ones) * (n - ones) * double(ref_ones) * (n - ref_ones));
+        const double phi = denom > 0 ? (double(n) * both - double(ones) * ref_ones) / denom : 0.;
+        const float correlation = equal ? phi : -phi;
+        const float perc = (mismatches / (double)cnt) * 100;
+        if (by_correlation ? correlation > 0 : perc < 50) {
+          result.push_back({id.address, (uint32_t)b, (uint32_t)j, mismatches, cnt, perc, correlation});
         }
       }
     }
+    return result;
+  };
+
+  const auto per_message = QtConcurrent::blockingMapped<std::vector<std::vector<mismatched_struct>>>(targets, compare);
+  QList<mismatched_struct> result;
+  for (const auto& r : per_message) result.append(QList<mismatched_struct>(r.begin(), r.end()));
+  if (by_correlation) {
+    std::ranges::sort(result, std::greater{}, &mismatched_struct::correlation);
+  } else {
+    std::ranges::sort(result, {}, &mismatched_struct::perc);
   }
-  std::ranges::sort(result, {}, &mismatched_struct::perc);
   return result;
 }
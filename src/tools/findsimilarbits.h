@@ -5,8 +5,11 @@
 #include <QLineEdit>
 #include <QSpinBox>
 #include <QTableWidget>
+#include <unordered_map>
+#include <vector>
 
 #include "core/dbc/dbc_manager.h"
+#include "core/streams/message_events.h"
 
 class FindSimilarBitsDlg : public QDialog {
   Q_OBJECT
@@ -18,16 +21,29 @@ class FindSimilarBitsDlg : public QDialog {
   void openMessage(const MessageId& msg_id);
 
  private:
+  // Every bit of a message as a column over time, 64 frames per word. Bits are numbered MSB-first
+  // within each byte, as in the dialog.
+  struct BitPlanes {
+    size_t frames = 0;
+    std::vector<std::vector<uint64_t>> bits;   // bits[byte * 8 + bit]
+    std::vector<std::vector<uint64_t>> valid;  // valid[byte]: frames long enough to carry it. Empty if all are.
+  };
   struct mismatched_struct {
     uint32_t address, byte_idx, bit_idx, mismatches, total;
     float perc;
+    float correlation;
   };
   QList<mismatched_struct> calcBits(uint8_t bus, uint32_t selected_address, int byte_idx, int bit_idx, uint8_t find_bus,
-                                    bool equal, int min_msgs_cnt);
+                                    bool equal, int min_msgs_cnt, bool by_correlation);
+  void updatePlanes(const std::vector<MessageId>& ids);
+  static BitPlanes buildPlanes(const MessageEvents& events);
   void find();
 
+  // Built on first use and reused by later queries until the message gets new events
+  std::unordered_map<MessageId, BitPlanes> planes_;
+
   QTableWidget* table;
-  QComboBox *src_bus_combo, *find_bus_combo, *msg_cb, *equal_combo;
+  QComboBox *src_bus_combo, *find_bus_combo, *msg_cb, *equal_combo, *rank_combo;
   QSpinBox *byte_idx_sb, *bit_idx_sb;
   QPushButton* search_btn;
   QLineEdit* min_msgs;
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+
+/**
+ * @brief Running state of one M4 bucket: the first, last, minimum and maximum sample
+ * that land in a single pixel column. Drawing just these four, in time order, covers
+ * exactly the pixels that drawing every sample of the column would.
+ */
+template <typename Key = uint64_t>
+struct M4Bucket {
+  double entry = 0.0, exit = 0.0;
+  double min = std::numeric_limits<double>::max();
+  double max = std::numeric_limits<double>::lowest();
+  Key entry_key = {}, exit_key = {}, min_key = {}, max_key = {};
+
+  void init(double y, Key key) {
+    entry = exit = min = max = y;
+    entry_key = exit_key = min_key = max_key = key;
+  }
+
+  void update(double y, Key key) {
+    exit = y;
+    exit_key = key;
+    if (y < min) {
+      min = y;
+      min_key = key;
+    }
+    if (y > max) {
+      max = y;
+      max_key = key;
+    }
+  }
+};
+
+// Reduces the x-sorted samples [first, last) to at most four per pixel column, where the column of
+// a sample is floor((x - x0) * px_per_unit). emit() receives the indices of the kept samples in order.
+template <typename XFn, typename YFn, typename EmitFn>
+void decimateM4(size_t first, size_t last, double x0, double px_per_unit, XFn&& x_of, YFn&& y_of, EmitFn&& emit) {
+  auto flush = [&](const M4Bucket<size_t>& b) {
+    size_t keys[] = {b.entry_key, b.min_key, b.max_key, b.exit_key};
+    std::sort(std::begin(keys), std::end(keys));
+    for (size_t i = 0; i < std::size(keys); ++i) {
+      if (i == 0 || keys[i] != keys[i - 1]) emit(keys[i]);
+    }
+  };
+
+  M4Bucket<size_t> bucket;
+  int64_t column = std::numeric_limits<int64_t>::min();
+  for (size_t i = first; i < last; ++i) {
+    const int64_t c = static_cast<int64_t>(std::floor((x_of(i) - x0) * px_per_unit));
+    if (c != column) {
+      if (i != first) flush(bucket);
+      bucket.init(y_of(i), i);
+      column = c;
+    } else {
+      bucket.update(y_of(i), i);
+    }
+  }
+  if (first < last) flush(bucket);
+}
@@ -1,69 +1,67 @@
 #include "series_bounds.h"
 
-void SeriesBounds::addPoint(double y) {
-  const size_t idx = count_++;
-
-  if (levels_.empty()) levels_.push_back({});
-
-  double cur_min = y;
-  double cur_max = y;
-
-  // Propagate updates up through the levels (Mipmapping)
-  for (size_t i = 0; i < levels_.size(); ++i) {
-    const size_t level_idx = idx / power_of_branch_[i + 1];
-
-    if (level_idx >= levels_[i].size()) {
-      levels_[i].push_back({cur_min, cur_max});
-    } else {
-      levels_[i][level_idx].combine(cur_min);
-      levels_[i][level_idx].combine(cur_max);
-    }
+std::pair<size_t, size_t> SeriesBounds::locate(size_t i) const {
+  const size_t b = std::upper_bound(offsets_.begin(), offsets_.end(), i) - offsets_.begin() - 1;
+  return {b, i - offsets_[b]};
+}
 
-    // If we didn't just fill a bucket, parent levels won't change
-    if ((idx + 1) % power_of_branch_[i + 1] != 0) break;
+void SeriesBounds::update(size_t first_block) {
+  offsets_.resize(blocks_.size());
+  for (size_t b = first_block; b < blocks_.size(); ++b) {
+    offsets_[b] = b == 0 ? 0 : offsets_[b - 1] + blocks_[b - 1].size;
+  }
 
-    cur_min = levels_[i][level_idx].min;
-    cur_max = levels_[i][level_idx].max;
+  // Propagate updates up through the levels (Mipmapping), starting at the first parent that changed
+  size_t first = first_block;
+  size_t children = blocks_.size();
+  size_t k = 0;
+  for (; children > 1; ++k) {
+    const size_t parents = (children + BRANCH_FACTOR - 1) / BRANCH_FACTOR;
+    if (k == levels_.size()) levels_.emplace_back();
+    levels_[k].resize(parents);
 
-    // Create next level if it doesn't exist yet
-    if (i + 1 == levels_.size() && i < 6) {
-      levels_.push_back({});
+    first /= BRANCH_FACTOR;
+    for (size_t p = first; p < parents; ++p) {
+      BoundsNode node;
+      for (size_t c = p * BRANCH_FACTOR; c < std::min((p + 1) * BRANCH_FACTOR, children); ++c) {
+        node.combine(k == 0 ? blocks_[c].bounds : levels_[k - 1][c]);
+      }
+      levels_[k][p] = node;
     }
+    children = parents;
   }
+  levels_.resize(k);
 }
 
-BoundsNode SeriesBounds::query(int l, int r, const std::vector<QPointF>& raw) const {
+BoundsNode SeriesBounds::queryBlocks(size_t first, size_t last) const {
   BoundsNode result;
-  if (l > r || r >= (int)raw.size()) return result;
-
-  int curr = l;
-  while (curr <= r) {
+  size_t curr = first;
+  while (curr <= last) {
+    // Find highest level node that fits entirely within [curr, last]
+    size_t step = 1;
     int best_lvl = -1;
-    int best_step = 1;
-
-    // Find highest level bucket that fits entirely within [curr, r]
-    for (int lvl = (int)levels_.size() - 1; lvl >= 0; --lvl) {
-      int step = (int)power_of_branch_[lvl + 1];
-      if (curr % step == 0 && curr + step - 1 <= r) {
-        best_lvl = lvl;
-        best_step = step;
-        break;
-      }
+    for (size_t lvl = 0, s = BRANCH_FACTOR; lvl < levels_.size(); ++lvl, s *= BRANCH_FACTOR) {
+      if (curr % s != 0 || curr + s - 1 > last) break;
+      best_lvl = lvl;
+      step = s;
     }
 
-    if (best_lvl != -1) {
-      result.combine(levels_[best_lvl][curr / best_step]);
-      curr += best_step;
-    } else {
-      // Leaf/Raw data fallback
-      result.combine(raw[curr].y());
-      curr++;
-    }
+    result.combine(best_lvl == -1 ? blocks_[curr].bounds : levels_[best_lvl][curr / step]);
+    curr += step;
   }
   return result;
 }
 
 void SeriesBounds::clear() {
+  blocks_.clear();
+  offsets_.clear();
   levels_.clear();
   count_ = 0;
 }
+
+size_t SeriesBounds::memoryUsage() const {
+  size_t bytes = blocks_.capacity() * sizeof(Block) + offsets_.capacity() * sizeof(size_t);
+  for (const auto& b : blocks_) bytes += b.leaves.capacity() * sizeof(BoundsNode);
+  for (const auto& level : levels_) bytes += level.capacity() * sizeof(BoundsNode);
+  return bytes;
+}
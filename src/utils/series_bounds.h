@@ -1,7 +1,8 @@
 #pragma once
-#include <QPointF>
 #include <algorithm>
+#include <cstdint>
 #include <limits>
+#include <utility>
 #include <vector>
 
 struct BoundsNode {
@@ -21,20 +22,145 @@ struct BoundsNode {
 
 /**
  * @brief SeriesBounds provides O(log N) min/max queries for a 1D signal.
- * It uses a hierarchical mipmap structure (branching factor of 8) to ensure
- * instant Y-axis scaling even on very long CAN logs.
+ * Points are grouped into blocks of up to BLOCK_SIZE, each summarised per leaf of
+ * BRANCH_FACTOR points. A mipmap (branching factor of 8) over the block summaries
+ * answers the rest of a query. Inserting a run of points in the middle only rebuilds
+ * the block it lands in and the mip levels above it, so out-of-order segments don't
+ * cost a full rebuild.
+ *
+ * The points themselves stay in the caller's series, which must provide size() and
+ * y(i) and already contain any points passed to insert().
  */
 class SeriesBounds {
  public:
-  static constexpr int BRANCH_FACTOR = 8;
+  static constexpr size_t BRANCH_FACTOR = 8;
+  static constexpr size_t BLOCK_SIZE = 512;
 
-  void addPoint(double y);
-  BoundsNode query(int l, int r, const std::vector<QPointF>& raw) const;
+  // Accounts for raw points [pos, pos + count), which were just inserted into raw.
+  template <typename Series>
+  void insert(size_t pos, size_t count, const Series& raw);
+  template <typename Series>
+  BoundsNode query(int l, int r, const Series& raw) const;
   void clear();
+  size_t memoryUsage() const;
 
  private:
-  std::vector<std::vector<BoundsNode>> levels_;
+  struct Block {
+    size_t size = 0;
+    BoundsNode bounds;
+    std::vector<BoundsNode> leaves;  // One node per BRANCH_FACTOR points
+  };
+
+  template <typename Series>
+  static Block makeBlock(const Series& raw, size_t first, size_t count);
+  template <typename Series>
+  BoundsNode queryBlock(size_t b, size_t lo, size_t hi, const Series& raw) const;
+  BoundsNode queryBlocks(size_t first, size_t last) const;
+  // Maps a point index to (block, offset)
+  std::pair<size_t, size_t> locate(size_t i) const;
+  // Recomputes offsets_ and the mip levels covering blocks [first_block, end)
+  void update(size_t first_block);
+
+  std::vector<Block> blocks_;
+  std::vector<size_t> offsets_;  // Index of the first point of each block
+  std::vector<std::vector<BoundsNode>> levels_;  // levels_[k][i] covers blocks [i * 8^(k+1), (i + 1) * 8^(k+1))
   size_t count_ = 0;
-  // Precomputed powers of BRANCH_FACTOR for speed
-  size_t power_of_branch_[8] = {1, 8, 64, 512, 4096, 32768, 262144, 2097152};
 };
+
+template <typename Series>
+SeriesBounds::Block SeriesBounds::makeBlock(const Series& raw, size_t first, size_t count) {
+  Block block;
+  block.size = count;
+  block.leaves.reserve((count + BRANCH_FACTOR - 1) / BRANCH_FACTOR);
+  for (size_t i = 0; i < count; i += BRANCH_FACTOR) {
+    BoundsNode leaf;
+    for (size_t j = i; j < std::min(i + BRANCH_FACTOR, count); ++j) leaf.combine(raw.y(first + j));
+    block.bounds.combine(leaf);
+    block.leaves.push_back(leaf);
+  }
+  return block;
+}
+
+template <typename Series>
+void SeriesBounds::insert(size_t pos, size_t count, const Series& raw) {
+  if (count == 0) return;
+
+  size_t first_block = blocks_.size();
+
+  if (pos == count_) {
+    // Appending: top up the last block before starting new ones
+    if (!blocks_.empty() && blocks_.back().size < BLOCK_SIZE) {
+      first_block = blocks_.size() - 1;
+      Block& last = blocks_.back();
+      const size_t taken = std::min(BLOCK_SIZE - last.size, count);
+      for (size_t i = 0; i < taken; ++i, ++last.size) {
+        const double y = raw.y(pos + i);
+        if (last.size % BRANCH_FACTOR == 0) {
+          last.leaves.push_back({y, y});
+        } else {
+          last.leaves.back().combine(y);
+        }
+        last.bounds.combine(y);
+      }
+      pos += taken;
+      count -= taken;
+    }
+  } else {
+    // Splicing: cut the block at pos, the tail moves behind the inserted points
+    auto [b, off] = locate(pos);
+    first_block = b;
+    const size_t tail = blocks_[b].size - off;
+    std::vector<Block> fresh;
+    blocks_.erase(blocks_.begin() + b);
+    if (off > 0) fresh.push_back(makeBlock(raw, pos - off, off));
+    for (size_t i = 0; i < count; i += BLOCK_SIZE) {
+      fresh.push_back(makeBlock(raw, pos + i, std::min(BLOCK_SIZE, count - i)));
+    }
+    fresh.push_back(makeBlock(raw, pos + count, tail));
+    blocks_.insert(blocks_.begin() + b, std::make_move_iterator(fresh.begin()), std::make_move_iterator(fresh.end()));
+    count_ += count;
+    update(first_block);
+    return;
+  }
+
+  for (size_t i = 0; i < count; i += BLOCK_SIZE) {
+    blocks_.push_back(makeBlock(raw, pos + i, std::min(BLOCK_SIZE, count - i)));
+  }
+  count_ = pos + count;
+  update(first_block);
+}
+
+template <typename Series>
+BoundsNode SeriesBounds::queryBlock(size_t b, size_t lo, size_t hi, const Series& raw) const {
+  const Block& block = blocks_[b];
+  if (lo == 0 && hi + 1 == block.size) return block.bounds;
+
+  BoundsNode result;
+  const size_t base = offsets_[b];
+  size_t i = lo;
+  while (i <= hi) {
+    if (i % BRANCH_FACTOR == 0 && i + BRANCH_FACTOR - 1 <= hi) {
+      result.combine(block.leaves[i / BRANCH_FACTOR]);
+      i += BRANCH_FACTOR;
+    } else {
+      result.combine(raw.y(base + i));
+      ++i;
+    }
+  }
+  return result;
+}
+
+template <typename Series>
+BoundsNode SeriesBounds::query(int l, int r, const Series& raw) const {
+  BoundsNode result;
+  if (l < 0 || l > r || r >= (int)raw.size() || (size_t)r >= count_) return result;
+
+  auto [lb, loff] = locate(l);
+  auto [rb, roff] = locate(r);
+  if (lb == rb) return queryBlock(lb, loff, roff, raw);
+
+  result.combine(queryBlock(lb, loff, blocks_[lb].size - 1, raw));
+  if (lb + 1 < rb) result.combine(queryBlocks(lb + 1, rb - 1));
+  result.combine(queryBlock(rb, 0, roff, raw));
+  return result;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer ring buffer.
+ * One thread may call tryPush() and one other thread may call tryPop()/drain().
+ * The capacity is rounded up to a power of two; pushes fail instead of blocking when full.
+ */
+template <typename T>
+class SpscQueue {
+ public:
+  explicit SpscQueue(size_t capacity) {
+    size_t n = 2;
+    while (n < capacity) n <<= 1;
+    mask_ = n - 1;
+    slots_ = std::make_unique<T[]>(n);
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  inline size_t capacity() const { return mask_ + 1; }
+
+  // Producer side
+  template <typename U>
+  bool tryPush(U&& value) {
+    return tryPushWith([&value](T& slot) { slot = std::forward<U>(value); });
+  }
+
+  // Producer side: lets fill write the element directly into its slot, avoiding a temporary.
+  template <typename Fn>
+  bool tryPushWith(Fn&& fill) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ > mask_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ > mask_) return false;
+    }
+    fill(slots_[tail & mask_]);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side
+  bool tryPop(T& value) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) return false;
+    }
+    value = std::move(slots_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side: hands every element queued so far to fn and releases them in one step.
+  template <typename Fn>
+  size_t drain(Fn&& fn) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    const size_t tail = cached_tail_ = tail_.load(std::memory_order_acquire);
+    for (size_t i = head; i != tail; ++i) {
+      fn(slots_[i & mask_]);
+    }
+    head_.store(tail, std::memory_order_release);
+    return tail - head;
+  }
+
+ private:
+  static constexpr size_t kCacheLine = 64;
+
+  size_t mask_ = 0;
+  std::unique_ptr<T[]> slots_;
+
+  // Producer and consumer indices live on separate cache lines, each next to the
+  // other side's cached copy that only its owner touches.
+  alignas(kCacheLine) std::atomic<size_t> head_ = 0;
+  size_t cached_tail_ = 0;
+  alignas(kCacheLine) std::atomic<size_t> tail_ = 0;
+  size_t cached_head_ = 0;
+};
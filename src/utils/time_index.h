@@ -1,3 +1,5 @@
+#pragma once
+
 #include <algorithm>
 #include <cstdint>
 #include <vector>
@@ -49,6 +51,10 @@ class TimeIndex {
 
   void clear() { indices_.clear(); }
 
+  // Raw bucket access, used to persist and restore the index without rescanning the data
+  const std::vector<size_t>& buckets() const { return indices_; }
+  void restore(std::vector<size_t>&& buckets) { indices_ = std::move(buckets); }
+
  private:
   std::vector<size_t> indices_;
 
@@ -18,6 +18,7 @@
 #include <mach/processor_info.h>
 #endif
 #include "modules/settings/settings.h"
+#include "modules/system/stream_manager.h"
 #include "replay/include/util.h"
 
 StatusBar::StatusBar(QWidget* parent) : QStatusBar(parent) {
@@ -113,7 +114,12 @@ void StatusBar::updateMetrics() {
   QString mem_val = QString::number(mem_mb, 'f', 0);
   mem_label_->setText(tr("MEM:%1 MB").arg(mem_val, 4));
 
-  status_label_->setText(tr("Cache: %1m | FPS: %2").arg(settings.max_cached_minutes).arg(settings.fps));
+  QString status = tr("Cache: %1m | FPS: %2").arg(settings.max_cached_minutes).arg(settings.fps);
+  if (auto* stream = StreamManager::stream()) {
+    if (uint64_t dropped = stream->droppedFrames()) status += tr(" | Dropped: %1").arg(dropped);
+    if (uint64_t dropped = stream->droppedLogMessages()) status += tr(" | Log Dropped: %1").arg(dropped);
+  }
+  status_label_->setText(status);
 }
 
 void StatusBar::updateDownloadProgress(uint64_t cur, uint64_t total, bool success) {